@@ -13,6 +13,8 @@
 #ifndef BITSIEVE_HPP
 #define BITSIEVE_HPP
 
+#include <HugePageAllocator.hpp>
+
 #include <cassert>
 #include <cstddef>
 #include <vector>
@@ -27,7 +29,7 @@ public:
 
   /// Pre-sieve the multiples (>= low) of the first c primes.
   /// @warning Also removes the first c primes.
-  /// @pre c < 10
+  /// @pre c <= 25
   ///
   void pre_sieve(uint64_t c,
                  uint64_t low);
@@ -63,6 +65,14 @@ public:
       return count_low_high - count_0_start - count(stop + 1, (high - 1) - low);
   }
 
+  /// Get the bit index of the number low + pos, BitSieve
+  /// stores all numbers hence this is pos itself.
+  ///
+  uint64_t get_index(uint64_t pos) const
+  {
+    return pos;
+  }
+
   void set(uint64_t pos)
   {
     assert(pos < size_);
@@ -81,14 +91,25 @@ public:
     return (sieve_[pos >> 6] >> (pos & 63)) & 1;
   }
 
+  /// Get the i-th 64-bit word of the sieve array
+  uint64_t get_word(uint64_t i) const
+  {
+    assert(i < sieve_.size());
+    return sieve_[i];
+  }
+
   std::size_t size() const
   {
     return size_;
   }
 private:
+  void get_pattern(uint64_t c);
   static const uint64_t unset_bit_[64];
-  std::vector<uint64_t> sieve_;
+  std::vector<uint64_t, HugePageAllocator<uint64_t> > sieve_;
+  const uint64_t* pattern_;
   std::size_t size_;
+  uint64_t pattern_c_;
+  uint64_t pattern_size_;
 };
 
 } // namespace
@@ -0,0 +1,156 @@
+///
+/// @file   BlockCounters.hpp
+/// @brief  The BlockCounters class is used for counting the number
+///         of unsieved elements in the sieve array when there are
+///         many special leaves per segment. It replaces Tomás
+///         Oliveira's special tree data structure (tos_counters.hpp)
+///         in S2_hard: for each 64-bit word of the sieve array we
+///         store its number of unsieved elements in an 8-bit
+///         counter and for each group of 64 words we store their
+///         number of unsieved elements in a 16-bit counter. Hence
+///         the counters use about 1/8 of the memory of the sieve
+///         array (the special tree uses 32x more memory than the
+///         sieve array) and they are initialized in O(N / 64).
+///
+///         Within each b the special leaves are processed in
+///         ascending order of x / n, hence we can count using a
+///         running cursor: a query only sums up the counters of
+///         the groups and words it skips and then counts the
+///         unsieved elements of the last word using POPCNT.
+///
+///         The counters are indexed by the bits of the sieve
+///         array, for BitSieve210 which does not store the
+///         multiples of 2, 3, 5 and 7 the number offsets must
+///         first be converted using sieve.get_index(pos).
+///
+/// Copyright (C) 2016 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef BLOCKCOUNTERS_HPP
+#define BLOCKCOUNTERS_HPP
+
+#include <popcount.hpp>
+#include <pmath.hpp>
+
+#include <cassert>
+#include <stdint.h>
+#include <vector>
+
+namespace primecount {
+
+/// @tparam Sieve  BitSieve or BitSieve210.
+template <typename Sieve>
+class BlockCounters
+{
+public:
+  /// Number of 64-bit words per group counter
+  static const uint64_t group_size = 1 << 6;
+
+  BlockCounters(const Sieve& sieve)
+    : sieve_(sieve),
+      total_(0),
+      cursor_(0),
+      sum_(0),
+      group_cursor_(0),
+      group_sum_(0)
+  { }
+
+  /// Initialize the counters from the first size
+  /// bits of the sieve array.
+  /// Runtime: O(N / 64).
+  ///
+  void init(uint64_t size)
+  {
+    assert(size > 0);
+    uint64_t words = ceil_div(size, 64);
+    counters_.resize(words);
+    groups_.assign(ceil_div(words, group_size), 0);
+    total_ = 0;
+
+    for (uint64_t i = 0; i < words; i++)
+    {
+      uint64_t bits = sieve_.get_word(i);
+      if (i == words - 1)
+        bits &= UINT64_C(0xffffffffffffffff) >> (63 - (size - 1) % 64);
+      counters_[i] = (uint8_t) popcount_u64(bits);
+      groups_[i / group_size] += counters_[i];
+      total_ += counters_[i];
+    }
+
+    reset();
+  }
+
+  /// Rewind the cursor to the start of the sieve array,
+  /// must be called before the queries of the next b.
+  ///
+  void reset()
+  {
+    cursor_ = 0;
+    sum_ = 0;
+    group_cursor_ = 0;
+    group_sum_ = 0;
+  }
+
+  /// Update (decrement) the counters after that the bit pos
+  /// has been crossed-off for the first time.
+  /// @warning reset() must be called before the next query.
+  /// Runtime: O(1).
+  ///
+  void unset(uint64_t pos)
+  {
+    counters_[pos / 64]--;
+    groups_[pos / (64 * group_size)]--;
+    total_--;
+  }
+
+  /// Get the number of unsieved bits <= pos.
+  /// @pre pos >= pos of the previous query (since reset()).
+  ///
+  uint64_t count(uint64_t pos)
+  {
+    uint64_t word = pos / 64;
+    uint64_t group = word / group_size;
+    assert(word >= cursor_);
+
+    if (group > group_cursor_)
+    {
+      for (; group_cursor_ < group; group_cursor_++)
+        group_sum_ += groups_[group_cursor_];
+
+      cursor_ = group * group_size;
+      sum_ = group_sum_;
+    }
+
+    for (; cursor_ < word; cursor_++)
+      sum_ += counters_[cursor_];
+
+    uint64_t bits = sieve_.get_word(word);
+    bits &= UINT64_C(0xffffffffffffffff) >> (63 - pos % 64);
+
+    return sum_ + popcount_u64(bits);
+  }
+
+  /// Get the number of unsieved elements in
+  /// the current segment.
+  ///
+  uint64_t count() const
+  {
+    return total_;
+  }
+private:
+  const Sieve& sieve_;
+  std::vector<uint8_t> counters_;
+  std::vector<uint16_t> groups_;
+  uint64_t total_;
+  uint64_t cursor_;
+  uint64_t sum_;
+  uint64_t group_cursor_;
+  uint64_t group_sum_;
+};
+
+} // namespace
+
+#endif
@@ -0,0 +1,93 @@
+///
+/// @file  EventCounters.hpp
+/// @brief Optional event counters for the hot paths of P2(x, y),
+///        S2_easy(x, y), S2_hard(x, y) and the PhiCache. The
+///        counters are compiled out by default, they are enabled
+///        using ./configure --enable-counters (-DENABLE_COUNTERS).
+///        Each thread counts into its own EventCounters object
+///        which is merged into the global counters once the thread
+///        has finished its work. The global counters are reset
+///        at the start and printed at the end of the computation
+///        when using --status.
+///
+/// Copyright (C) 2016 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef EVENTCOUNTERS_HPP
+#define EVENTCOUNTERS_HPP
+
+#include <stdint.h>
+
+#if defined(ENABLE_COUNTERS)
+  #define COUNT_EVENT(events, event, n) (events).add(event, n)
+#else
+  // reference events to avoid unused parameter warnings
+  #define COUNT_EVENT(events, event, n) ((void) (events))
+#endif
+
+namespace primecount {
+
+enum Event
+{
+  /// Primes iterated by the P2(x, y) sieve
+  P2_PRIMES,
+  /// Number of pi(x / prime) values summed up
+  P2_SUMS,
+  /// Clustered easy leaves and iterations needed to find them
+  S2_EASY_CLUSTERED_LEAVES,
+  S2_EASY_CLUSTERED_STEPS,
+  S2_EASY_SPARSE_LEAVES,
+  /// Hard special leaves of c < b <= pi[sqrt(y)]
+  S2_HARD_LEAVES_SQRTY,
+  /// Hard special leaves of pi[sqrt(y)] < b <= pi[sqrt(z)]
+  S2_HARD_LEAVES_SQRTZ,
+  /// FactorTable lookups, leaves + rejections
+  S2_HARD_FACTOR_LOOKUPS,
+  /// Block counter queries and updates
+  S2_HARD_CNT_QUERY,
+  S2_HARD_CNT_UPDATE,
+  /// 64-bit words scanned by BitSieve::count()
+  S2_HARD_SIEVE_WORDS,
+  /// Multiples of the sieving primes crossed off
+  S2_HARD_CROSS_OFFS,
+  PHI_CACHE_HITS,
+  PHI_CACHE_MISSES,
+  NUM_EVENTS
+};
+
+class EventCounters
+{
+public:
+#if defined(ENABLE_COUNTERS)
+  EventCounters()
+  {
+    for (int i = 0; i < NUM_EVENTS; i++)
+      counts_[i] = 0;
+  }
+
+  void add(Event event, int64_t n)
+  {
+    counts_[event] += n;
+  }
+
+  /// Add to the global counters and reset (thread safe)
+  void merge();
+private:
+  int64_t counts_[NUM_EVENTS];
+#else
+  void merge() { }
+#endif
+};
+
+/// Reset the global counters
+void reset_event_counters();
+
+/// Print the global counters if --status is used
+void print_event_counters();
+
+} // namespace
+
+#endif
@@ -4,7 +4,11 @@
 ///        the lpf[n] (least prime factor) and mu[n] (Möbius function)
 ///        lookup tables into a single factors_[n] table which
 ///        furthermore only contains entries for numbers which are
-///        not divisible by 2, 3, 5 and 7.
+///        not divisible by 2, 3, 5 and 7 (WHEEL = 210) or not
+///        divisible by 2, 3, 5, 7 and 11 (WHEEL = 2310). The
+///        2310 wheel uses 9% less memory but it requires that
+///        only numbers whose least prime factor is > 11 are
+///        looked up.
 ///        The factor table concept has first been devised and
 ///        implemented by Christian Bau in 2003.
 ///
@@ -30,12 +34,14 @@
 #include <primesieve.hpp>
 #include <pmath.hpp>
 #include <int128.hpp>
+#include <TableCache.hpp>
 
 #include <algorithm>
 #include <cassert>
 #include <limits>
+#include <sstream>
 #include <stdint.h>
-#include <vector>
+#include <string>
 
 #ifdef _OPENMP
   #include <omp.h>
@@ -47,7 +53,9 @@ namespace primecount {
 /// data and it used to convert:
 /// 1) A number into a FactorTable index.
 /// 2) A FactorTable index into a number.
+/// @tparam WHEEL  210 or 2310.
 ///
+template <int WHEEL>
 class AbstractFactorTable
 {
 protected:
@@ -65,35 +73,69 @@ public:
   static int64_t get_index(uint64_t number)
   {
     assert(number > 0);
-    uint64_t q = number / 210;
-    uint64_t r = number % 210;
-    return 48 * q + indexes_[r];
+    uint64_t q = number / WHEEL;
+    uint64_t r = number % WHEEL;
+    return COPRIMES * q + indexes_[r];
   }
 
   static int64_t get_number(uint64_t index)
   {
-    uint64_t q = index / 48;
-    uint64_t r = index % 48;
-    return 210 * q + numbers_[r];
+    uint64_t q = index / COPRIMES;
+    uint64_t r = index % COPRIMES;
+    return WHEEL * q + numbers_[r];
   }
 
 private:
-  static const uint8_t numbers_[48];
-  static const  int8_t indexes_[210];
+  /// Number of residues coprime to WHEEL
+  enum { COPRIMES = (WHEEL == 210) ? 48 : 480 };
+  static const uint16_t numbers_[COPRIMES];
+  static const  int16_t indexes_[WHEEL];
 };
 
-template <typename T>
-class FactorTable : public AbstractFactorTable
+/// The FactorTable with the 2310 wheel does not contain
+/// the multiples of 11, this is only correct if all
+/// looked up numbers m satisfy lpf(m) > primes[c + 1] >= 11.
+/// The 210 wheel can be selected using --wheel=210.
+///
+inline bool use_wheel2310(int64_t c)
+{
+  return get_wheel() == 2310 && c >= 4;
+}
+
+template <typename T, int WHEEL = 210>
+class FactorTable : public AbstractFactorTable<WHEEL>
 {
 public:
+  using AbstractFactorTable<WHEEL>::get_index;
+  using AbstractFactorTable<WHEEL>::get_number;
+
   /// Factor numbers <= y
   FactorTable(int64_t y, int threads)
   {
     if (y > max())
       throw primecount_error("y must be <= FactorTable::max().");
     y = std::max<int64_t>(8, y);
-    T T_MAX = std::numeric_limits<T>::max();
-    init_factors(y, T_MAX, threads);
+
+    if (!factors_.load(cache_name(), y, table_size))
+    {
+      T T_MAX = std::numeric_limits<T>::max();
+      init_factors(y, T_MAX, threads);
+      factors_.save(cache_name(), y, table_size);
+    }
+  }
+
+  /// Number of factors_ elements of the FactorTable(y)
+  static uint64_t table_size(int64_t y)
+  {
+    return get_index(std::max<int64_t>(8, y)) + 1;
+  }
+
+  /// e.g. "factors2310_u16"
+  static std::string cache_name()
+  {
+    std::ostringstream oss;
+    oss << "factors" << WHEEL << "_u" << sizeof(T) * 8;
+    return oss.str();
   }
 
   static maxint_t max()
@@ -186,7 +228,7 @@ private:
   }
 
   /// Find the first multiple > low of prime which
-  /// is not divisible by any prime <= 7.
+  /// is not divisible by any prime of the wheel.
   ///
   static int64_t next_multiple(int64_t low,
                                int64_t prime,
@@ -203,7 +245,7 @@ private:
     return multiple;
   }
 
-  std::vector<T> factors_;
+  CacheArray<T> factors_;
 };
 
 } // namespace
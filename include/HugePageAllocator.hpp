@@ -0,0 +1,109 @@
+///
+/// @file  HugePageAllocator.hpp
+/// @brief The large lookup tables (PiTable, FactorTable) are
+///        accessed in a random pattern, for large x most of these
+///        accesses cause a TLB miss when using the default 4 KiB
+///        pages. HugePageAllocator is a std::allocator replacement
+///        which (if enabled using --hugepages) allocates large
+///        arrays using huge pages (usually 2 MiB): first using
+///        hugetlbfs (MAP_HUGETLB) and if no huge pages have been
+///        reserved using transparent huge pages (MADV_HUGEPAGE).
+///        Huge pages are only supported on Linux.
+///
+/// Copyright (C) 2016 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef HUGEPAGEALLOCATOR_HPP
+#define HUGEPAGEALLOCATOR_HPP
+
+#include <cstddef>
+#include <new>
+#include <string>
+
+namespace primecount {
+
+/// Allocate memory using huge pages if enabled and if
+/// bytes >= huge page size, else using operator new.
+///
+void* hugepage_alloc(std::size_t bytes);
+
+/// Free memory allocated using hugepage_alloc(bytes),
+/// munmap() or operator delete is chosen per allocation.
+///
+void hugepage_free(void* ptr, std::size_t bytes);
+
+/// @return  The page size obtained for the large
+///          allocations e.g. "2 MiB (MAP_HUGETLB)".
+///
+std::string get_page_size();
+
+template <typename T>
+class HugePageAllocator
+{
+public:
+  typedef T value_type;
+  typedef T* pointer;
+  typedef const T* const_pointer;
+  typedef T& reference;
+  typedef const T& const_reference;
+  typedef std::size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+
+  template <typename U>
+  struct rebind
+  {
+    typedef HugePageAllocator<U> other;
+  };
+
+  HugePageAllocator() { }
+
+  template <typename U>
+  HugePageAllocator(const HugePageAllocator<U>&) { }
+
+  pointer address(reference x) const { return &x; }
+  const_pointer address(const_reference x) const { return &x; }
+
+  pointer allocate(size_type n, const void* = 0)
+  {
+    return (pointer) hugepage_alloc(n * sizeof(T));
+  }
+
+  void deallocate(pointer ptr, size_type n)
+  {
+    hugepage_free(ptr, n * sizeof(T));
+  }
+
+  size_type max_size() const
+  {
+    return ((size_type) -1) / sizeof(T);
+  }
+
+  void construct(pointer ptr, const T& value)
+  {
+    new ((void*) ptr) T(value);
+  }
+
+  void destroy(pointer ptr)
+  {
+    ptr->~T();
+  }
+};
+
+template <typename T, typename U>
+bool operator==(const HugePageAllocator<T>&, const HugePageAllocator<U>&)
+{
+  return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const HugePageAllocator<T>&, const HugePageAllocator<U>&)
+{
+  return false;
+}
+
+} // namespace
+
+#endif
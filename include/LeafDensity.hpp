@@ -0,0 +1,78 @@
+///
+/// @file  LeafDensity.hpp
+/// @brief Estimates the remaining work of S2_hard(x, y). The
+///        work needed to sieve an interval [low, high[ is modelled
+///        as the cross-off work (which depends on the number of
+///        sieving primes) plus the work of the hard special leaves
+///        whose x / n lies inside [low, high[. The work is
+///        integrated once over [1, z] using a leaf-density model.
+///        The seconds per unit of work are calibrated using the
+///        measured timings of the finished intervals.
+///
+/// Copyright (C) 2016 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef LEAFDENSITY_HPP
+#define LEAFDENSITY_HPP
+
+#include <int128.hpp>
+
+#include <stdint.h>
+#include <vector>
+
+namespace primecount {
+
+class LeafDensity
+{
+public:
+  LeafDensity(maxint_t x, int64_t y, int64_t z, int64_t c);
+
+  /// Add the finished interval [low, high[ which
+  /// took seconds (summed over all its threads)
+  ///
+  void add(int64_t low, int64_t high, double seconds);
+
+  /// Add the interval [low, high[ which has been
+  /// finished previously e.g. before --resume
+  ///
+  void skip(int64_t low, int64_t high);
+
+  /// @return  Percent of the work that has been done
+  double percent() const;
+
+  /// @return  The smallest limit <= z + 1 for which the
+  ///          interval [1, limit[ contains >= percent
+  ///          of the total work.
+  ///
+  int64_t find_limit(double percent) const;
+
+  /// Estimated seconds (summed over all threads)
+  /// needed to finish the remaining work.
+  /// @return  -1 if not yet calibrated
+  ///
+  double remaining_seconds() const;
+
+private:
+  double sieve_density(double t) const;
+  double leaf_density(double t) const;
+  double get_work(int64_t low, int64_t high) const;
+  double cumulative(double t) const;
+  double x_;
+  double y_;
+  double z_;
+  double pc_;
+  double step_;
+  std::vector<double> work_;
+  double done_;
+  /// Least squares sums of the measured
+  /// work and seconds
+  double ww_;
+  double wt_;
+};
+
+} // namespace
+
+#endif
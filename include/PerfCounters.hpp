@@ -0,0 +1,79 @@
+///
+/// @file  PerfCounters.hpp
+/// @brief Hardware performance counters using Linux'
+///        perf_event_open(2), enabled using --perf. Each thread
+///        of the parallel formulas (P2, S1, S2_easy, S2_hard)
+///        creates a PerfCounters object which counts the events
+///        of the calling thread until it is destroyed. When a
+///        formula finishes, print(res_str, res, time) assigns the
+///        counts of its threads to the formula (add_perf_stage()).
+///        On other operating systems or if the kernel does not
+///        allow access to the counters no events are counted.
+///
+/// Copyright (C) 2016 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef PERFCOUNTERS_HPP
+#define PERFCOUNTERS_HPP
+
+#include <stdint.h>
+#include <map>
+#include <string>
+
+namespace primecount {
+
+enum PerfEvent
+{
+  PERF_CYCLES,
+  PERF_INSTRUCTIONS,
+  PERF_L1D_MISSES,
+  PERF_LLC_MISSES,
+  PERF_DTLB_MISSES,
+  PERF_BRANCH_MISSES,
+  NUM_PERF_EVENTS
+};
+
+/// Counts of the events, -1 if an event is not supported
+struct PerfValues
+{
+  PerfValues();
+  PerfValues& operator+=(const PerfValues& other);
+  int64_t values[NUM_PERF_EVENTS];
+};
+
+class PerfCounters
+{
+public:
+  PerfCounters();
+  ~PerfCounters();
+private:
+  PerfCounters(const PerfCounters&);
+  PerfCounters& operator=(const PerfCounters&);
+  int fds_[NUM_PERF_EVENTS];
+  int thread_num_;
+};
+
+void set_perf(bool enable);
+
+bool is_perf();
+
+/// @return Name of the event e.g. "cycles"
+const char* perf_event_name(int event);
+
+/// Assign the counts of the threads that finished since
+/// the last call to the formula name and print them
+/// if --status is used.
+///
+void add_perf_stage(const std::string& name);
+
+/// Total counts of each formula since the last reset_perf()
+std::map<std::string, PerfValues> get_perf_stages();
+
+void reset_perf();
+
+} // namespace
+
+#endif
@@ -1,5 +1,6 @@
 ///
 /// @file  PhiTiny.hpp
+/// @see   PhiTiny.cpp for documentation.
 ///
 /// Copyright (C) 2016 Kim Walisch, <kim.walisch@gmail.com>
 ///
@@ -11,6 +12,7 @@
 #define PHITINY_HPP
 
 #include <int128.hpp>
+#include <popcount.hpp>
 
 #include <stdint.h>
 #include <cassert>
@@ -21,7 +23,7 @@ namespace primecount {
 class PhiTiny {
 public:
   PhiTiny();
-  static int64_t max_a() { return 6; }
+  static int64_t max_a() { return 8; }
   static bool is_tiny(int64_t a) { return a <= max_a(); }
 
   /// Partial sieve function (a.k.a. Legendre-sum).
@@ -36,7 +38,13 @@ public:
     // phi(x, a) = (x / pp) * φ(pp) + phi(x % pp, a)
     // with pp = 2 * 3 * ... * prime[a]
     X pp = prime_products[a];
-    return (x / pp) * totients[a] + phi_cache_[a][x % pp];
+    X q = x / pp;
+    int64_t r = (int64_t) (x % pp);
+
+    if (a <= max_cache_a)
+      return q * totients[a] + phi_cache_[a][r];
+    else
+      return q * totients[a] + phi_bitmap(r, a);
   }
 
   static int64_t get_c(int64_t y)
@@ -49,11 +57,34 @@ public:
       return pi[y];
   }
 private:
-  std::vector<int16_t> phi_cache_[7];
+  /// phi(x, a) for x < pp = 2 * 3 * ... * prime[a] and a > 6.
+  /// Uses the symmetry phi(x, a) = φ(pp) - phi(pp - x - 1, a)
+  /// and the odd coprime numbers < pp / 2 which are stored in
+  /// phi_bitmap_[a] (1 bit per odd number) together with the
+  /// count of 1 bits before each 64-bit word.
+  ///
+  int64_t phi_bitmap(int64_t x, int64_t a) const
+  {
+    if (x >= prime_products[a] / 2)
+      return totients[a] - phi_bitmap(prime_products[a] - x - 1, a);
+
+    // number of odd numbers <= x
+    uint64_t n = (x + 1) / 2;
+    uint64_t bits = phi_bitmap_[a][n / 64];
+    uint64_t mask = (((uint64_t) 1) << (n % 64)) - 1;
+
+    return phi_counts_[a][n / 64] + popcount_u64(bits & mask);
+  }
+
+  /// Use uncompressed phi_cache_ lookup tables for a <= 6
+  enum { max_cache_a = 6 };
+  std::vector<int16_t> phi_cache_[max_cache_a + 1];
+  std::vector<uint64_t> phi_bitmap_[9];
+  std::vector<uint32_t> phi_counts_[9];
   static const int pi[20];
-  static const int primes[7];
-  static const int prime_products[7];
-  static const int totients[7];
+  static const int primes[9];
+  static const int prime_products[9];
+  static const int totients[9];
 };
 
 inline bool is_phi_tiny(int64_t a)
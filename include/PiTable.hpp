@@ -24,17 +24,18 @@
 #define PITABLE_HPP
 
 #include <popcount.hpp>
+#include <TableCache.hpp>
 
 #include <stdint.h>
 #include <cassert>
-#include <vector>
+#include <string>
 
 namespace primecount {
 
 class PiTable
 {
 public:
-  PiTable(uint64_t max);
+  PiTable(uint64_t max, int threads);
 
   /// @return  The number of primes <= n
   int64_t operator[](uint64_t n) const
@@ -48,7 +49,18 @@ public:
   {
     return max_ + 1;
   }
+
+  static std::string cache_name()
+  {
+    return "pi";
+  }
 private:
+  /// Number of pi_ elements of the PiTable(max)
+  static uint64_t table_size(int64_t max)
+  {
+    return max / 64 + 1;
+  }
+
   struct PiData
   {
     PiData() : prime_count(0), bits(0) { }
@@ -56,7 +68,7 @@ private:
     uint64_t bits;
   };
 
-  std::vector<PiData> pi_;
+  CacheArray<PiData> pi_;
   uint64_t max_;
 };
 
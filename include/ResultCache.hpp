@@ -0,0 +1,44 @@
+///
+/// @file  ResultCache.hpp
+/// @brief Persistent on-disk cache of pi(x) results. If a result
+///        cache file has been set (--result-cache=<file>) pi(x)
+///        first looks up the cached x0 nearest to x. If x0 is
+///        close to x, pi(x) = pi(x0) +/- the primes between x0
+///        and x which are counted using the segmented sieve of
+///        Eratosthenes. The new results are appended to the file.
+///
+///        Result cache file format (plain text):
+///        primecount-results <version>
+///        followed by one "x pi(x) checksum" line per result,
+///        the checksum is the FNV-1a hash (hex) of "x pi(x)".
+///
+///        Multiple primecount processes may share a result cache
+///        file, on POSIX systems appends are serialized using an
+///        fcntl() lock. Each process reads the file only once,
+///        hence it does not see the results added by other
+///        processes after that.
+///
+/// Copyright (C) 2016 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef RESULTCACHE_HPP
+#define RESULTCACHE_HPP
+
+#include <int128.hpp>
+
+namespace primecount {
+
+/// @return  true if x or a cached x0 close to
+///          x has been found, pix = pi(x).
+///
+bool result_cache_find(maxint_t x, int threads, maxint_t* pix);
+
+/// Append pi(x) to the result cache file
+void result_cache_add(maxint_t x, maxint_t pix);
+
+} // namespace
+
+#endif
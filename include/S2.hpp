@@ -78,16 +78,21 @@ int64_t S2_hard(int64_t x,
                 int64_t y,
                 int64_t z,
                 int64_t c,
-                int64_t s2_hard_approx,
                 int threads);
 
+double S2_hard_sample_seconds(int64_t x,
+                              int64_t y,
+                              int64_t z,
+                              int64_t c,
+                              double percent,
+                              int threads);
+
 #ifdef HAVE_INT128_T
 
 int128_t S2_hard(int128_t x,
                  int64_t y,
                  int64_t z,
                  int64_t c,
-                 int128_t s2_hard_approx,
                  int threads);
 
 #endif
@@ -98,7 +103,6 @@ int64_t S2_hard_mpi(int64_t x,
                     int64_t y,
                     int64_t z,
                     int64_t c,
-                    int64_t s2_hard_approx,
                     int threads);
 
 #ifdef HAVE_INT128_T
@@ -107,7 +111,6 @@ int128_t S2_hard_mpi(int128_t x,
                      int64_t y,
                      int64_t z,
                      int64_t c,
-                     int128_t s2_hard_approx,
                      int threads);
 
 #endif
@@ -0,0 +1,65 @@
+///
+/// @file  S2Checkpoint.hpp
+/// @brief Save and restore the state of S2_hard(x, y) so that
+///        long running computations can be resumed after a
+///        crash or a reboot.
+///
+/// Copyright (C) 2016 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef S2CHECKPOINT_HPP
+#define S2CHECKPOINT_HPP
+
+#include <S2LoadBalancer.hpp>
+#include <int128.hpp>
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace primecount {
+
+class S2Checkpoint
+{
+public:
+  S2Checkpoint(maxint_t x, int64_t y, int64_t z, int64_t c);
+  bool is_enabled() const;
+
+  /// Stop saving checkpoints, e.g. after a failed save
+  void disable();
+
+  /// Restore the state of S2_hard from the --resume=<file>.
+  /// @return  false if no resume file has been provided.
+  ///
+  bool load(int64_t* low,
+            int64_t* segment_size,
+            int64_t* segments_per_thread,
+            maxint_t* s2_hard,
+            std::vector<int64_t>& phi_total,
+            S2LoadBalancer& loadBalancer);
+
+  /// Save the state of S2_hard if the last checkpoint
+  /// is older than the checkpoint interval.
+  ///
+  void save(int64_t low,
+            int64_t segment_size,
+            int64_t segments_per_thread,
+            maxint_t s2_hard,
+            const std::vector<int64_t>& phi_total,
+            const S2LoadBalancer& loadBalancer,
+            bool force = false);
+private:
+  maxint_t x_;
+  int64_t y_;
+  int64_t z_;
+  int64_t c_;
+  double last_save_;
+  std::string filename_;
+};
+
+} // namespace
+
+#endif
@@ -14,6 +14,7 @@
 #include <int128.hpp>
 
 #include <stdint.h>
+#include <iosfwd>
 
 namespace primecount {
 
@@ -29,6 +30,8 @@ public:
               int64_t* segment_size,
               int64_t* segments_per_thread,
               aligned_vector<double>& timings);
+  void save_state(std::ostream& out) const;
+  void load_state(std::istream& in);
 private:
   void init(maxint_t x, int64_t y, int64_t threads);
   void set_min_size(int64_t z);
@@ -14,12 +14,15 @@
 
 namespace primecount {
 
+class LeafDensity;
+
 class S2Status
 {
 public:
   S2Status(maxint_t x);
   void print(maxint_t n, maxint_t limit);
   void print(maxint_t n, maxint_t limit, double rsd);
+  void print(const LeafDensity& density, int threads, double rsd);
   double skewed_percent(maxint_t n, maxint_t limit) const;
 private:
   bool is_print(double time) const;
@@ -0,0 +1,249 @@
+///
+/// @file  TableCache.hpp
+/// @brief Persistent on-disk cache of the lookup tables
+///        (FactorTable, PiTable and the primes). If a cache
+///        directory has been set (--cache=<dir>) the tables are
+///        memory mapped from their cache files instead of being
+///        sieved. A cache file built for a limit >= y can also
+///        be used for y because the tables only differ in size.
+///        The cache files are written by --build-cache=<dir>.
+///        The batch pi(xs) keeps the tables in memory using
+///        the table store, see set_table_store().
+///
+///        Cache file format (native byte order):
+///        CacheHeader followed by size elements of type T.
+///        The header contains the limit the table has been
+///        built for and a checksum of the elements, cache
+///        files whose size does not match their limit or
+///        whose checksum does not match are rebuilt.
+///
+/// Copyright (C) 2016 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef TABLECACHE_HPP
+#define TABLECACHE_HPP
+
+#include <HugePageAllocator.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace primecount {
+
+/// Reference counted table of the table store
+struct StoredTable;
+
+/// Read-only memory mapping of a file or a reference to a
+/// table of the table store. A referenced table stays alive
+/// until it is unmapped, even if it has been removed from
+/// the table store in the meantime.
+///
+class MappedFile
+{
+public:
+  MappedFile();
+  ~MappedFile();
+  /// @return false if the file cannot be mapped
+  bool map(const std::string& filename);
+  /// @pre The reference count of table has
+  ///      been incremented for this MappedFile.
+  ///
+  void share(StoredTable* table);
+  void unmap();
+  const char* data() const { return data_; }
+  std::size_t size() const { return size_; }
+private:
+  MappedFile(const MappedFile&);
+  MappedFile& operator=(const MappedFile&);
+  const char* data_;
+  std::size_t size_;
+  StoredTable* table_;
+};
+
+/// @return  true if --build-cache is used
+bool is_build_cache();
+
+/// While enabled the tables are kept in memory and a table
+/// built for a limit >= limit is reused instead of being
+/// rebuilt. Calls nest, the tables are freed once each
+/// set_table_store(true) has been matched by a
+/// set_table_store(false). Thread safe.
+///
+void set_table_store(bool enable);
+
+bool is_table_store();
+
+/// Map the table name from the table store or from its cache
+/// file if it exists, has been written by this version of
+/// primecount, has been built for a limit >= limit, its
+/// elements have type_size bytes and its checksum matches.
+/// @param size        Number of elements of the cache file.
+/// @param file_limit  Limit the cache file has been built for.
+/// @return            Pointer to the first element or NULL.
+///
+const void* cache_map(MappedFile& file,
+                      const std::string& name,
+                      std::size_t type_size,
+                      int64_t limit,
+                      uint64_t* size,
+                      int64_t* file_limit);
+
+/// Write the cache file of the table name (if --build-cache
+/// is used) and add it to the table store (if enabled).
+///
+void cache_save(const std::string& name,
+                std::size_t type_size,
+                int64_t limit,
+                const void* data,
+                uint64_t size);
+
+/// @return  Size of the cache file of the
+///          table name in bytes, 0 if none.
+///
+int64_t cache_file_size(const std::string& name);
+
+/// CacheArray is the storage of the lookup tables, it is
+/// either a vector which is filled by its table or it
+/// is memory mapped from the table's cache file or from
+/// the table store. file_ keeps the mapped data alive.
+/// Copies are never memory mapped.
+///
+template <typename T>
+class CacheArray
+{
+public:
+  CacheArray()
+    : data_(0),
+      size_(0)
+  { }
+
+  CacheArray(const CacheArray& other)
+    : array_(other.data_, other.data_ + other.size_)
+  {
+    update();
+  }
+
+  CacheArray& operator=(const CacheArray& other)
+  {
+    if (this != &other)
+    {
+      array_.assign(other.data_, other.data_ + other.size_);
+      file_.unmap();
+      update();
+    }
+    return *this;
+  }
+
+  void resize(std::size_t size, const T& value = T())
+  {
+    array_.resize(size, value);
+    update();
+  }
+
+  /// Map the first table_size(limit) elements from the
+  /// cache file. The cache file must contain exactly
+  /// table_size(file_limit) elements.
+  /// @return false if there is no valid cache file
+  ///
+  bool load(const std::string& name,
+            int64_t limit,
+            uint64_t (*table_size)(int64_t))
+  {
+    uint64_t file_size = 0;
+    int64_t file_limit = 0;
+    const void* data = cache_map(file_, name, sizeof(T), limit, &file_size, &file_limit);
+
+    if (!data || file_size != table_size(file_limit))
+    {
+      file_.unmap();
+      return false;
+    }
+
+    std::vector<T, HugePageAllocator<T> >().swap(array_);
+    data_ = (const T*) data;
+    size_ = (std::size_t) table_size(limit);
+    return true;
+  }
+
+  /// If the table store is enabled, the array is
+  /// replaced by the table store's copy, so that the
+  /// table is only kept in memory once.
+  ///
+  void save(const std::string& name,
+            int64_t limit,
+            uint64_t (*table_size)(int64_t))
+  {
+    cache_save(name, sizeof(T), limit, data_, size_);
+
+    if (is_table_store())
+      load(name, limit, table_size);
+  }
+
+  /// @pre Not memory mapped
+  T& operator[](std::size_t i)
+  {
+    return array_[i];
+  }
+
+  const T& operator[](std::size_t i) const
+  {
+    return data_[i];
+  }
+
+  std::size_t size() const
+  {
+    return size_;
+  }
+private:
+  void update()
+  {
+    data_ = array_.empty() ? 0 : &array_[0];
+    size_ = array_.size();
+  }
+
+  std::vector<T, HugePageAllocator<T> > array_;
+  const T* data_;
+  std::size_t size_;
+  MappedFile file_;
+};
+
+/// Copy the primes <= max from the primes cache
+/// file, the primes are cached as int64_t.
+/// @return false if there is no valid cache file
+///
+template <typename T, typename A>
+bool cache_load_primes(int64_t max, std::vector<T, A>& primes)
+{
+  MappedFile file;
+  uint64_t size = 0;
+  int64_t file_limit = 0;
+  const int64_t* data = (const int64_t*) cache_map(file, "primes", sizeof(int64_t), max, &size, &file_limit);
+
+  // primes[0] = 0 and the largest prime <= file_limit
+  if (!data || size < 1 || data[0] != 0 || data[size - 1] > file_limit)
+    return false;
+
+  const int64_t* end = std::upper_bound(data + 1, data + size, max);
+  primes.assign(data, end);
+  return true;
+}
+
+template <typename T, typename A>
+void cache_save_primes(int64_t max, const std::vector<T, A>& primes)
+{
+  if (!is_build_cache() && !is_table_store())
+    return;
+
+  std::vector<int64_t> data(primes.begin(), primes.end());
+  cache_save("primes", sizeof(int64_t), max, &data[0], data.size());
+}
+
+} // namespace
+
+#endif
@@ -11,8 +11,11 @@
 #define GENERATE_HPP
 
 #include <primesieve.hpp>
+#include <TableCache.hpp>
 
 #include <stdint.h>
+#include <algorithm>
+#include <cmath>
 #include <vector>
 
 namespace primecount {
@@ -24,11 +27,44 @@ template <typename T>
 std::vector<T> generate_primes(int64_t max)
 {
   std::vector<T> primes;
-  primes.push_back(0);
-  primesieve::generate_primes(max, &primes);
+
+  if (!cache_load_primes(max, primes))
+  {
+    primes.push_back(0);
+    primesieve::generate_primes(max, &primes);
+    cache_save_primes(max, primes);
+  }
+
   return primes;
 }
 
+/// Generate the primes <= max into a vector using the
+/// allocator A e.g. HugePageAllocator. The primes are
+/// generated in place, there is no temporary copy.
+/// The primes vector uses 1-indexing i.e. primes[1] = 2.
+///
+template <typename T, typename A>
+void generate_primes(int64_t max, std::vector<T, A>& primes)
+{
+  primes.clear();
+
+  if (!cache_load_primes(max, primes))
+  {
+    // pi(x) < 1.26 x / log(x) for x >= 17
+    double n = (double) std::max(max, (int64_t) 17);
+    primes.reserve((std::size_t) (1.26 * n / std::log(n)) + 2);
+    primes.push_back(0);
+
+    primesieve::iterator it(0, max);
+    uint64_t prime = it.next_prime();
+
+    for (; prime <= (uint64_t) max; prime = it.next_prime())
+      primes.push_back((T) prime);
+
+    cache_save_primes(max, primes);
+  }
+}
+
 /// Generate a vector with the primes <= max.
 /// The primes vector uses 1-indexing i.e. primes[1] = 2.
 //
@@ -0,0 +1,121 @@
+///
+/// @file  numa.hpp
+/// @brief On NUMA systems the lookup tables (FactorTable, PiTable
+///        and the primes) which are read by all threads in
+///        S2_hard(x, y) and S2_easy(x, y) are located in the
+///        memory of a single node, hence the threads running on
+///        the other nodes pay remote memory latency on every
+///        lookup. If NUMA is enabled (--numa) each worker thread
+///        is pinned to a NUMA node (round-robin) and the tables
+///        are replicated once per NUMA node so that all lookups
+///        access local memory. NUMA is only supported on Linux.
+///
+/// Copyright (C) 2016 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef NUMA_HPP
+#define NUMA_HPP
+
+#include <cstddef>
+#include <vector>
+
+#if defined(__linux__)
+  #include <sched.h>
+#endif
+
+namespace primecount {
+
+/// @return  Number of NUMA nodes used by primecount,
+///          1 if NUMA is disabled or not supported.
+///
+int numa_nodes();
+
+/// Pins the calling thread to the CPUs of the NUMA node
+/// thread_num % numa_nodes() where thread_num is the
+/// OpenMP thread number of the calling thread. The previous
+/// CPU affinity of the thread is restored when the binding
+/// goes out of scope, the OpenMP pool threads (including
+/// the master thread) are reused by the later computations.
+///
+class NumaBinding
+{
+public:
+  NumaBinding();
+  ~NumaBinding();
+
+  /// @return  The NUMA node of the calling thread
+  int node() const
+  {
+    return node_;
+  }
+private:
+  NumaBinding(const NumaBinding&);
+  NumaBinding& operator=(const NumaBinding&);
+  int node_;
+  bool is_bound_;
+#if defined(__linux__)
+  cpu_set_t old_cpuset_;
+#endif
+};
+
+/// NumaReplicas holds one copy of a read-only table per
+/// NUMA node. Each copy is created by a thread pinned to its
+/// NUMA node, hence the operating system allocates its memory
+/// on that node (first touch policy). If NUMA is disabled the
+/// original table is used and no memory is allocated.
+///
+template <typename T>
+class NumaReplicas
+{
+public:
+  NumaReplicas(const T& table)
+    : table_(table)
+  {
+    int nodes = numa_nodes();
+
+    if (nodes > 1)
+    {
+      replicas_.resize(nodes, (T*) 0);
+
+      #pragma omp parallel num_threads(nodes)
+      {
+        NumaBinding binding;
+        replicas_[binding.node()] = new T(table);
+      }
+
+      // in case OpenMP used fewer threads
+      for (int i = 0; i < nodes; i++)
+        if (!replicas_[i])
+          replicas_[i] = new T(table);
+    }
+  }
+
+  ~NumaReplicas()
+  {
+    for (std::size_t i = 0; i < replicas_.size(); i++)
+      delete replicas_[i];
+  }
+
+  /// Get the table local to the given NUMA node
+  /// @see NumaBinding
+  ///
+  const T& operator[](int node) const
+  {
+    if (replicas_.empty())
+      return table_;
+
+    return *replicas_[node];
+  }
+private:
+  NumaReplicas(const NumaReplicas&);
+  NumaReplicas& operator=(const NumaReplicas&);
+  const T& table_;
+  std::vector<T*> replicas_;
+};
+
+} // namespace
+
+#endif
@@ -4,7 +4,9 @@
 ///          word or an array. If HAVE_POPCNT is defined then
 ///          popcnt_u64(x) will be used which uses the POPCNT
 ///          instruction (requires SSE4.2 for x86). For performance
-///          reasons all algorithms are defined inline.
+///          reasons all algorithms are defined inline except the
+///          AVX2 and AVX-512 kernels for large arrays which are
+///          selected at runtime (see popcount_avx.cpp).
 ///
 /// Copyright (C) 2016 Kim Walisch, <kim.walisch@gmail.com>
 ///
@@ -92,6 +94,14 @@ inline uint64_t popcnt_u64(uint64_t x)
 
 #if defined(HAVE_POPCNT_U64)
 
+// HAVE_AVX2 and HAVE_AVX512_VPOPCNTDQ are defined if the compiler
+// supports these instruction sets, whether the CPU supports them
+// is checked at runtime.
+#if defined(HAVE_AVX2) || \
+    defined(HAVE_AVX512_VPOPCNTDQ)
+  #define HAVE_POPCOUNT_AVX
+#endif
+
 namespace primecount {
 
 inline uint64_t popcount_u64(uint64_t x)
@@ -102,7 +112,7 @@ inline uint64_t popcount_u64(uint64_t x)
 /// Count the number of 1 bits in an array using the POPCNT
 /// instruction. On x86 CPUs this requires SSE4.2.
 ///
-inline uint64_t popcount_u64(const uint64_t* array, uint64_t size)
+inline uint64_t popcnt_array(const uint64_t* array, uint64_t size)
 {
   uint64_t sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
   uint64_t limit = size - size % 4;
@@ -124,6 +134,34 @@ inline uint64_t popcount_u64(const uint64_t* array, uint64_t size)
   return total;
 }
 
+#if defined(HAVE_POPCOUNT_AVX)
+
+/// Arrays with fewer 64-bit words are counted
+/// using popcnt_array(), larger arrays are counted
+/// using popcount_avx().
+///
+const uint64_t popcount_avx_min_size = 64;
+
+/// Count the number of 1 bits in an array using
+/// AVX-512 VPOPCNTDQ or AVX2 (Harley-Seal) if
+/// supported by the CPU, else using popcnt_array().
+/// @see popcount_avx.cpp
+///
+uint64_t popcount_avx(const uint64_t* array, uint64_t size);
+
+#endif
+
+/// Count the number of 1 bits in an array
+inline uint64_t popcount_u64(const uint64_t* array, uint64_t size)
+{
+#if defined(HAVE_POPCOUNT_AVX)
+  if (size >= popcount_avx_min_size)
+    return popcount_avx(array, size);
+#endif
+
+  return popcnt_array(array, size);
+}
+
 } // namespace
 
 #else /* no POPCNT */
@@ -32,6 +32,32 @@ std::string pi(const std::string& x, int threads);
 
 int64_t pi(int64_t x, int threads);
 
+std::vector<int64_t> pi(const std::vector<int64_t>& xs, int threads);
+
+std::vector<std::string> pi(const std::vector<std::string>& xs, int threads);
+
+std::string pi_range(const std::string& a, const std::string& b, int threads);
+
+int64_t pi_range(int64_t a, int64_t b, int threads);
+
+#ifdef HAVE_INT128_T
+
+int128_t pi_range(int128_t a, int128_t b, int threads);
+
+#endif
+
+/// @return true if counting the primes inside [a, b] using
+/// the segmented sieve of Eratosthenes is expected to be
+/// faster than pi(b) - pi(a - 1).
+///
+bool is_sieve_range(maxint_t a, maxint_t b);
+
+/// @return  true if counting the primes inside [a, b] using
+/// the segmented sieve of Eratosthenes is expected to be
+/// faster than computing pi(b).
+///
+bool is_sieve_gap(maxint_t a, maxint_t b);
+
 #ifdef HAVE_INT128_T
 
 int128_t pi(int128_t x);
@@ -92,24 +118,44 @@ int64_t pi_meissel(int64_t x, int threads);
 
 int64_t pi_primesieve(int64_t x, int threads);
 
+int64_t pi_primesieve(int64_t a, int64_t b, int threads);
+
 int64_t phi(int64_t x, int64_t a, int threads);
 
 int64_t Li(int64_t);
 
 int64_t Li_inverse(int64_t);
 
+int64_t RiemannR(int64_t);
+
+int64_t RiemannR_inverse(int64_t);
+
 #ifdef HAVE_INT128_T
 
 int128_t Li(int128_t);
 
 int128_t Li_inverse(int128_t);
 
+int128_t RiemannR(int128_t);
+
+int128_t RiemannR_inverse(int128_t);
+
 #endif
 
+std::string nth_prime(const std::string& n, int threads);
+
 int64_t nth_prime(int64_t n, int threads);
 
+#ifdef HAVE_INT128_T
+
+int128_t nth_prime(int128_t n, int threads);
+
+#endif
+
 int64_t P2(int64_t x, int64_t y, int threads);
 
+double P2_sample_seconds(int64_t x, int64_t y, int threads);
+
 int64_t P3(int64_t x, int64_t a, int threads);
 
 #ifdef HAVE_INT128_T
@@ -132,8 +178,46 @@ double get_alpha_lmo(maxint_t x);
 
 double get_alpha_deleglise_rivat(maxint_t x);
 
+bool get_alpha_profile(const std::string& name, maxint_t x, double (*formula)(double), double* alpha);
+
+void tune(int64_t max_x, int threads);
+
+void benchmark(maxint_t max_x, int threads, int repeat, const std::string& json);
+
+void set_max_memory(int64_t bytes);
+
+bool is_max_memory();
+
+double deleglise_rivat_memory(maxint_t x, double alpha, int threads);
+
+double fit_memory_alpha(maxint_t x, double alpha);
+
+int fit_memory_threads(maxint_t x, double alpha, int threads);
+
 double get_wtime();
 
+void sleep_us(int64_t microseconds);
+
+void set_checkpoint_file(const std::string& filename);
+
+void set_resume_file(const std::string& filename);
+
+void set_numa(bool enable);
+
+void set_hugepages(bool enable);
+
+bool is_hugepages();
+
+void set_wheel(int wheel);
+
+int get_wheel();
+
+void set_cache_dir(const std::string& dir);
+
+void set_build_cache(bool enable);
+
+int64_t build_cache(int64_t y, int64_t z, int64_t c, int threads);
+
 int ideal_num_threads(int threads, int64_t sieve_limit, int64_t thread_threshold = 100000);
 
 maxint_t to_maxint(const std::string& expr);
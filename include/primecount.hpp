@@ -11,6 +11,7 @@
 
 #include <stdexcept>
 #include <string>
+#include <vector>
 #include <stdint.h>
 
 #define PRIMECOUNT_VERSION "3.4"
@@ -37,6 +38,32 @@ int64_t pi(int64_t x);
 ///
 std::string pi(const std::string& x);
 
+/// Count the primes below each x of xs. The lookup tables
+/// (primes, PiTable, FactorTable) are built once for the
+/// largest x and reused for all smaller x, this is much
+/// faster than calling pi(x) for each x of the same decade.
+/// @return  pi(xs[i]) at index i.
+///
+std::vector<int64_t> pi(const std::vector<int64_t>& xs);
+
+/// 128-bit variant of the batch pi(xs).
+/// @param xs  Integer arithmetic expressions e.g. "10^22"
+/// @pre   xs  <= get_max_x()
+///
+std::vector<std::string> pi(const std::vector<std::string>& xs);
+
+/// Count the primes inside [a, b]. If b - a is small the
+/// primes are counted using the segmented sieve of
+/// Eratosthenes, else pi(b) - pi(a - 1) is computed.
+///
+int64_t pi_range(int64_t a, int64_t b);
+
+/// 128-bit variant of pi_range(a, b).
+/// @param a, b  Integer arithmetic expressions e.g. "10^22"
+/// @pre   b <= get_max_x()
+///
+std::string pi_range(const std::string& a, const std::string& b);
+
 /// Calculate the number of primes below x using the
 /// Deleglise-Rivat algorithm.
 /// Run time: O(x^(2/3) / (log x)^2) operations, O(x^(1/3) * (log x)^3) space.
@@ -77,6 +104,12 @@ int64_t pi_primesieve(int64_t x);
 ///
 int64_t nth_prime(int64_t n);
 
+/// 128-bit variant of nth_prime(n), the nth prime
+/// must be < 2^64 i.e. n <= 425656284035217743.
+/// @param n  Integer arithmetic expression e.g. "10^17"
+///
+std::string nth_prime(const std::string& n);
+
 /// Partial sieve function (a.k.a. Legendre-sum).
 /// phi(x, a) counts the numbers <= x that are not divisible
 /// by any of the first a primes.
@@ -95,6 +128,20 @@ int64_t Li(int64_t x);
 ///
 int64_t Li_inverse(int64_t x);
 
+/// Enable the persistent result cache, the pi(x) results are
+/// appended to filename. If x is close to a cached x0 pi(x)
+/// is computed by sieving the gap between x0 and x.
+/// An empty filename disables the result cache.
+///
+void set_result_cache(const std::string& filename);
+
+/// Set the maximum distance between x and a cached x0 whose gap
+/// is sieved. By default (-1) the gap is sieved if this is
+/// expected to be faster than computing pi(x), 0 only
+/// uses cached results of the same x.
+///
+void set_result_distance(int64_t distance);
+
 /// Enable/disable printing status information during computation.
 void set_print_status(bool print_status);
 
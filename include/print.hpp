@@ -13,6 +13,7 @@
 #include <int128.hpp>
 #include <stdint.h>
 
+#include <map>
 #include <string>
 
 namespace primecount {
@@ -37,6 +38,13 @@ void print(const std::string& res_name, maxint_t res, double time);
 
 void print_seconds(double seconds);
 
+/// Seconds spent in each formula e.g. "P2", "S2_hard"
+/// since the last reset_timings().
+///
+std::map<std::string, double> get_timings();
+
+void reset_timings();
+
 } // namespace
 
 #endif
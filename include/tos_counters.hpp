@@ -26,7 +26,8 @@
 namespace primecount {
 
 /// Initialize the counters from the sieve array.
-/// @pre segment_size is a power of 2.
+/// The counters are a 0-indexed Fenwick tree, hence
+/// segment_size can be any positive integer.
 /// @pre sieve[i] = 1 for unsieved elements and sieve[i] = 0
 ///      for crossed-off elements.
 /// Runtime: O(N log N).
@@ -44,7 +45,6 @@ inline void cnt_finit(const T1& sieve, std::vector<T2>& cnt, int64_t segment_siz
 
 /// Update (decrement) the counters after that an element has been
 /// crossed-off for the first time in the sieve array.
-/// @pre segment_size is a power of 2.
 /// Runtime: O(log N).
 ///
 template <typename T>
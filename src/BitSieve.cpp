@@ -22,43 +22,58 @@
 #include <stdint.h>
 #include <algorithm>
 #include <cassert>
-#include <cstring>
 #include <vector>
 
 using namespace std;
+using namespace primecount;
 
 namespace {
 
 /// 1-indexing: primes[1] = 2, primes[2] = 3, ...
-const uint64_t primes[] = { 0, 2, 3, 5, 7, 11, 13, 17, 19, 23 };
-
-/// Bitmasks with multiples of the i-th prime set
-const uint64_t masks[] =
+const uint64_t primes[] =
 {
-  UINT64_C(0x0000000000000000),
-  UINT64_C(0x5555555555555555), // 2
-  UINT64_C(0x9249249249249249), // 3
-  UINT64_C(0x1084210842108421), // 5
-  UINT64_C(0x8102040810204081), // 7
-  UINT64_C(0x0080100200400801), // 11
-  UINT64_C(0x0010008004002001), // 13
-  UINT64_C(0x0008000400020001), // 17
-  UINT64_C(0x0200004000080001), // 19
-  UINT64_C(0x0000400000800001)  // 23
+   0,  2,  3,  5,  7, 11, 13, 17, 19, 23,
+  29, 31, 37, 41, 43, 47, 53, 59, 61, 67,
+  71, 73, 79, 83, 89, 97
 };
 
-/// Get bitmask with unset multiples
-uint64_t unset_mask(uint64_t mask, uint64_t shift)
-{
-  return ~(mask << shift);
-}
+/// The pre-sieve pattern contains at most the first 8 primes,
+/// 2 * 3 * 5 * 7 * 11 * 13 * 17 * 19 = 9699690 bits (1.2 MiB).
+///
+const uint64_t max_pattern_c = 8;
+
+/// The pre-sieve patterns are shared by all BitSieve objects,
+/// each pattern is only initialized once as initializing the
+/// pattern of the first 8 primes is much slower than sieving a
+/// segment and S2_hard creates a new BitSieve for each interval.
+///
+vector<uint64_t> patterns[max_pattern_c + 1];
+
+uint64_t pattern_sizes[max_pattern_c + 1];
 
-/// @pre x < y * 2
-uint64_t fast_modulo(uint64_t x, uint64_t y)
+/// Initialize the pre-sieve pattern for the first c primes. The
+/// pattern is a bit array in which the i-th bit corresponds to
+/// the number i, the pattern repeats every primes[1] * ... *
+/// primes[c] bits. We store the smallest multiple of the period
+/// >= 128 bits plus 128 extra bits so that 64 bits can be read
+/// starting at any position < pattern_size.
+///
+void init_pattern(uint64_t c)
 {
-  x = (x < y) ? x : x - y;
-  assert(x < y);
-  return x;
+  uint64_t period = 1;
+  for (uint64_t i = 1; i <= c; i++)
+    period *= primes[i];
+
+  uint64_t pattern_size = ceil_div(128, period) * period;
+  vector<uint64_t> pattern(ceil_div(pattern_size + 128, 64), UINT64_C(0xffffffffffffffff));
+  uint64_t bits = pattern.size() * 64;
+
+  for (uint64_t i = 1; i <= c; i++)
+    for (uint64_t j = 0; j < bits; j += primes[i])
+      pattern[j >> 6] &= ~(UINT64_C(1) << (j & 63));
+
+  pattern_sizes[c] = pattern_size;
+  patterns[c].swap(pattern);
 }
 
 }
@@ -93,68 +108,77 @@ const uint64_t BitSieve::unset_bit_[64] =
 
 BitSieve::BitSieve(std::size_t size) :
   sieve_(ceil_div(size, 64)),
-  size_(size)
+  pattern_(0),
+  size_(size),
+  pattern_c_(0),
+  pattern_size_(0)
 { }
 
+/// Get the shared pre-sieve pattern of the first c primes
+void BitSieve::get_pattern(uint64_t c)
+{
+  #pragma omp critical (BitSieve_pattern)
+  {
+    if (patterns[c].empty())
+      init_pattern(c);
+
+    pattern_ = &patterns[c][0];
+    pattern_size_ = pattern_sizes[c];
+  }
+
+  pattern_c_ = c;
+}
+
 /// Pre-sieve the multiples (>= low) of the first c primes.
+/// The sieve array is initialized by copying the precomputed
+/// pattern of the first min(c, 8) primes starting at the bit
+/// offset low % period. The multiples of the remaining
+/// primes (if any) are crossed-off individually.
 /// @warning Also removes the first c primes.
-/// @pre c < 10
+/// @pre c <= 25
 ///
 void BitSieve::pre_sieve(uint64_t c, uint64_t low)
 {
-  assert(c < 10);
+  assert(c < sizeof(primes) / sizeof(primes[0]));
 
   if (sieve_.empty())
     return;
 
-  // unset multiples of 2
-  sieve_[0] = unset_mask(masks[1], low % 2);
+  // the multiples of 2 are always removed
+  uint64_t pattern_c = max<uint64_t>(1, min(c, max_pattern_c));
 
-  uint64_t last = 1;
-  uint64_t sieved = last;
+  if (pattern_c != pattern_c_)
+    get_pattern(pattern_c);
+
+  uint64_t pos = low % pattern_size_;
   uint64_t sieve_size = sieve_.size();
 
-  // pre-sieve multiples of first c primes
-  for (uint64_t i = 2; i <= c; i++)
+  for (uint64_t i = 0; i < sieve_size; i++)
   {
-    uint64_t prime = primes[i];
-    uint64_t end_copy = min(sieved * prime, sieve_size);
-
-    // pre-sieve multiples of primes < i-th prime
-    // by copying a small pre-sieved buffer
-    while (last < end_copy)
-    {
-      uint64_t copy_words = min(sieved, sieve_size - last);
-      copy(sieve_.begin(),
-           sieve_.begin() + copy_words,
-           sieve_.begin() + last);
-      last += copy_words;
-    }
-
-    // calculate first multiple >= low of prime
-    uint64_t multiple = ceil_div(low, prime) * prime;
-    uint64_t shift = multiple - low;
-    uint64_t next_shift = prime - 64 % prime;
-    uint64_t mask = masks[i];
-
-    // pre-sieve multiples of the i-th prime
-    for (uint64_t j = 0; j < last; j++)
-    {
-      sieve_[j] &= unset_mask(mask, shift);
-      shift = fast_modulo(shift + next_shift, prime);
-    }
-
-    sieved = last;
+    uint64_t j = pos / 64;
+    uint64_t shift = pos % 64;
+
+    if (shift == 0)
+      sieve_[i] = pattern_[j];
+    else
+      sieve_[i] = (pattern_[j] >> shift) | (pattern_[j + 1] << (64 - shift));
+
+    pos += 64;
+    if (pos >= pattern_size_)
+      pos -= pattern_size_;
   }
 
-  // fill up the rest of the sieve
-  while (last < sieve_size)
+  uint64_t high = low + sieve_size * 64;
+
+  // cross-off the multiples of the primes
+  // that are not part of the pattern
+  for (uint64_t i = pattern_c + 1; i <= c; i++)
   {
-    uint64_t copy_words = min(sieved, sieve_size - last);
-    copy(sieve_.begin(),
-         sieve_.begin() + copy_words,
-         sieve_.begin() + last);
-    last += copy_words;
+    uint64_t prime = primes[i];
+    uint64_t multiple = ceil_div(low, prime) * prime;
+
+    for (; multiple < high; multiple += prime)
+      sieve_[(multiple - low) >> 6] &= unset_bit_[(multiple - low) & 63];
   }
 }
 
@@ -0,0 +1,254 @@
+///
+/// @file  BitSieve210.cpp
+/// @brief The BitSieve210 class is a bit array for use with
+///        Eratosthenes-like prime sieving algorithms. Unlike
+///        BitSieve it only stores the numbers which are coprime
+///        to 210 (48 out of 210 integers), this way the
+///        segments of the sieve cover about 4.4x more numbers
+///        using the same amount of memory.
+///
+/// Copyright (C) 2016 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#if !defined(__STDC_CONSTANT_MACROS)
+  #define __STDC_CONSTANT_MACROS
+#endif
+
+#include <BitSieve210.hpp>
+#include <popcount.hpp>
+#include <pmath.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+using namespace std;
+using namespace primecount;
+
+namespace {
+
+/// 1-indexing: primes[1] = 2, primes[2] = 3, ...
+const uint64_t primes[] =
+{
+   0,  2,  3,  5,  7, 11, 13, 17, 19, 23,
+  29, 31, 37, 41, 43, 47, 53, 59, 61, 67,
+  71, 73, 79, 83, 89, 97
+};
+
+/// The 48 numbers < 210 which are coprime to 210
+const uint8_t coprimes[48] =
+{
+    1,  11,  13,  17,  19,  23,  29,  31,  37,  41,  43,  47,
+   53,  59,  61,  67,  71,  73,  79,  83,  89,  97, 101, 103,
+  107, 109, 113, 121, 127, 131, 137, 139, 143, 149, 151, 157,
+  163, 167, 169, 173, 179, 181, 187, 191, 193, 197, 199, 209
+};
+
+/// The pre-sieve pattern contains at most the first 8 primes,
+/// the multiples of 2, 3, 5 and 7 are not stored, hence the
+/// largest pattern has 48 * 11 * 13 * 17 * 19 bits (271 KiB).
+///
+const uint64_t max_pattern_c = 8;
+
+/// The pre-sieve patterns are shared by all BitSieve210
+/// objects, each pattern is only initialized once.
+///
+vector<uint64_t> patterns[max_pattern_c + 1];
+
+uint64_t pattern_sizes[max_pattern_c + 1];
+
+/// Initialize the pre-sieve pattern for the first c primes.
+/// The i-th bit of the pattern corresponds to the number
+/// 210 * (i / 48) + coprimes[i % 48], the pattern repeats
+/// every 48 * primes[5] * ... * primes[c] bits. We store the
+/// smallest multiple of the period >= 128 bits plus 128 extra
+/// bits so that 64 bits can be read starting at any
+/// position < pattern_size.
+///
+void init_pattern(uint64_t c)
+{
+  uint64_t period = 48;
+  for (uint64_t i = BitSieve210::min_c + 1; i <= c; i++)
+    period *= primes[i];
+
+  uint64_t pattern_size = ceil_div(128, period) * period;
+  vector<uint64_t> pattern(ceil_div(pattern_size + 128, 64), UINT64_C(0xffffffffffffffff));
+  uint64_t bits = pattern.size() * 64;
+
+  for (uint64_t j = 0; j < bits; j++)
+  {
+    uint64_t n = 210 * (j / 48) + coprimes[j % 48];
+    for (uint64_t i = BitSieve210::min_c + 1; i <= c; i++)
+      if (n % primes[i] == 0)
+        pattern[j >> 6] &= ~(UINT64_C(1) << (j & 63));
+  }
+
+  pattern_sizes[c] = pattern_size;
+  patterns[c].swap(pattern);
+}
+
+}
+
+namespace primecount {
+
+/// wheel_offsets_[r] is the index of the largest
+/// number <= r which is coprime to 210 (-1 for r = 0).
+///
+const int8_t BitSieve210::wheel_offsets_[210] =
+{
+  -1,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  1,
+   1,  2,  2,  2,  2,  3,  3,  4,  4,  4,  4,  5,
+   5,  5,  5,  5,  5,  6,  6,  7,  7,  7,  7,  7,
+   7,  8,  8,  8,  8,  9,  9, 10, 10, 10, 10, 11,
+  11, 11, 11, 11, 11, 12, 12, 12, 12, 12, 12, 13,
+  13, 14, 14, 14, 14, 14, 14, 15, 15, 15, 15, 16,
+  16, 17, 17, 17, 17, 17, 17, 18, 18, 18, 18, 19,
+  19, 19, 19, 19, 19, 20, 20, 20, 20, 20, 20, 20,
+  20, 21, 21, 21, 21, 22, 22, 23, 23, 23, 23, 24,
+  24, 25, 25, 25, 25, 26, 26, 26, 26, 26, 26, 26,
+  26, 27, 27, 27, 27, 27, 27, 28, 28, 28, 28, 29,
+  29, 29, 29, 29, 29, 30, 30, 31, 31, 31, 31, 32,
+  32, 32, 32, 32, 32, 33, 33, 34, 34, 34, 34, 34,
+  34, 35, 35, 35, 35, 35, 35, 36, 36, 36, 36, 37,
+  37, 38, 38, 38, 38, 39, 39, 39, 39, 39, 39, 40,
+  40, 41, 41, 41, 41, 41, 41, 42, 42, 42, 42, 43,
+  43, 44, 44, 44, 44, 45, 45, 46, 46, 46, 46, 46,
+  46, 46, 46, 46, 46, 47
+};
+
+/// The numbers of a segment start at most 210 - 1
+/// numbers after the first bit, see get_index().
+///
+BitSieve210::BitSieve210(std::size_t size) :
+  sieve_(ceil_div((size / 210 + 2) * 48, 64)),
+  pattern_(0),
+  size_(size),
+  offset_(210),
+  pattern_c_(0),
+  pattern_size_(0)
+{ }
+
+/// Get the shared pre-sieve pattern of the first c primes
+void BitSieve210::get_pattern(uint64_t c)
+{
+  #pragma omp critical (BitSieve210_pattern)
+  {
+    if (patterns[c].empty())
+      init_pattern(c);
+
+    pattern_ = &patterns[c][0];
+    pattern_size_ = pattern_sizes[c];
+  }
+
+  pattern_c_ = c;
+}
+
+/// Pre-sieve the multiples (>= low) of the first c primes.
+/// The multiples of 2, 3, 5 and 7 are not stored, the sieve
+/// array is initialized by copying the precomputed pattern of
+/// the primes[5] ... primes[min(c, 8)] starting at the wheel
+/// of low. The multiples of the remaining primes (if any)
+/// are crossed-off individually.
+/// @warning Also removes the first c primes.
+/// @pre c >= 4 && c <= 25
+///
+void BitSieve210::pre_sieve(uint64_t c, uint64_t low)
+{
+  assert(c >= min_c);
+  assert(c < sizeof(primes) / sizeof(primes[0]));
+
+  offset_ = low % 210;
+  if (offset_ == 0)
+    offset_ = 210;
+
+  if (sieve_.empty())
+    return;
+
+  uint64_t pattern_c = min(c, max_pattern_c);
+
+  if (pattern_c != pattern_c_)
+    get_pattern(pattern_c);
+
+  uint64_t wheels = pattern_size_ / 48;
+  uint64_t pos = ((low - offset_) / 210 % wheels) * 48;
+  uint64_t sieve_size = sieve_.size();
+
+  for (uint64_t i = 0; i < sieve_size; i++)
+  {
+    uint64_t j = pos / 64;
+    uint64_t shift = pos % 64;
+
+    if (shift == 0)
+      sieve_[i] = pattern_[j];
+    else
+      sieve_[i] = (pattern_[j] >> shift) | (pattern_[j + 1] << (64 - shift));
+
+    pos += 64;
+    if (pos >= pattern_size_)
+      pos -= pattern_size_;
+  }
+
+  // remove the numbers < low of the first wheel
+  uint64_t below_low = wheel_offsets_[offset_ - 1] + 1;
+  sieve_[0] &= UINT64_C(0xffffffffffffffff) << below_low;
+
+  uint64_t high = low + size_;
+
+  // cross-off the multiples of the primes
+  // that are not part of the pattern
+  for (uint64_t i = pattern_c + 1; i <= c; i++)
+  {
+    uint64_t prime = primes[i];
+    uint64_t multiple = ceil_div(low, prime) * prime;
+
+    for (; multiple < high; multiple += prime)
+    {
+      uint64_t r = (multiple - low + offset_) % 210;
+      if (r > 0 && wheel_offsets_[r] != wheel_offsets_[r - 1])
+        unset(get_index(multiple - low));
+    }
+  }
+}
+
+/// Count the number of 1 bits of the
+/// numbers inside [low + start, low + stop]
+///
+uint64_t BitSieve210::count(uint64_t start,
+                            uint64_t stop) const
+{
+  if (start > stop)
+    return 0;
+
+  assert(stop < size_);
+
+  // the numbers < low are not set,
+  // hence we can start counting at bit 0
+  uint64_t first = (start > 0) ? get_index(start - 1) + 1 : 0;
+  uint64_t last = get_index(stop);
+
+  if (first > last)
+    return 0;
+
+  uint64_t start_idx = first / 64;
+  uint64_t stop_idx = last / 64;
+  uint64_t m1 = UINT64_C(0xffffffffffffffff) << (first % 64);
+  uint64_t m2 = UINT64_C(0xffffffffffffffff) >> (63 - last % 64);
+  uint64_t bit_count;
+
+  if (start_idx == stop_idx)
+    bit_count = popcount_u64(sieve_[start_idx] & (m1 & m2));
+  else
+  {
+    bit_count = popcount_u64(sieve_[start_idx] & m1);
+    bit_count += popcount_u64(&sieve_[start_idx + 1], stop_idx - (start_idx + 1));
+    bit_count += popcount_u64(sieve_[stop_idx] & m2);
+  }
+
+  return bit_count;
+}
+
+} // namespace
@@ -0,0 +1,111 @@
+///
+/// @file  EventCounters.cpp
+/// @brief Global event counters, see EventCounters.hpp.
+///
+/// Copyright (C) 2016 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <EventCounters.hpp>
+#include <print.hpp>
+
+#include <stdint.h>
+#include <iomanip>
+#include <iostream>
+
+using namespace std;
+using namespace primecount;
+
+namespace {
+
+#if defined(ENABLE_COUNTERS)
+
+int64_t events_[NUM_EVENTS];
+
+const char* names[NUM_EVENTS] =
+{
+  "P2 primes",
+  "P2 sums",
+  "S2_easy clustered leaves",
+  "S2_easy clustered steps",
+  "S2_easy sparse leaves",
+  "S2_hard leaves b <= pi(sqrt(y))",
+  "S2_hard leaves b > pi(sqrt(y))",
+  "S2_hard FactorTable lookups",
+  "S2_hard cnt_query",
+  "S2_hard cnt_update",
+  "S2_hard sieve words counted",
+  "S2_hard cross-offs",
+  "PhiCache hits",
+  "PhiCache misses"
+};
+
+double ratio(int64_t a, int64_t b)
+{
+  return (b > 0) ? (double) a / b : 0;
+}
+
+#endif
+
+} // namespace
+
+namespace primecount {
+
+#if defined(ENABLE_COUNTERS)
+
+void EventCounters::merge()
+{
+  #pragma omp critical (EventCounters)
+  for (int i = 0; i < NUM_EVENTS; i++)
+    events_[i] += counts_[i];
+
+  for (int i = 0; i < NUM_EVENTS; i++)
+    counts_[i] = 0;
+}
+
+#endif
+
+void reset_event_counters()
+{
+#if defined(ENABLE_COUNTERS)
+  #pragma omp critical (EventCounters)
+  for (int i = 0; i < NUM_EVENTS; i++)
+    events_[i] = 0;
+#endif
+}
+
+void print_event_counters()
+{
+#if defined(ENABLE_COUNTERS)
+  if (!print_status())
+    return;
+
+  cout << endl;
+  cout << "=== Event counters ===" << endl;
+
+  for (int i = 0; i < NUM_EVENTS; i++)
+    if (events_[i] > 0)
+      cout << names[i] << " = " << events_[i] << endl;
+
+  int64_t leaves = events_[S2_HARD_LEAVES_SQRTY] + events_[S2_HARD_LEAVES_SQRTZ];
+  int64_t lookups = events_[S2_HARD_FACTOR_LOOKUPS];
+  int64_t hits = events_[PHI_CACHE_HITS];
+  int64_t misses = events_[PHI_CACHE_MISSES];
+
+  cout << fixed << setprecision(3);
+
+  if (lookups > 0)
+    cout << "S2_hard FactorTable rejections = "
+         << lookups - events_[S2_HARD_LEAVES_SQRTY] << endl;
+  if (leaves > 0)
+    cout << "S2_hard sieve words per leaf = "
+         << ratio(events_[S2_HARD_SIEVE_WORDS], leaves) << endl;
+  if (hits + misses > 0)
+    cout << "PhiCache hit rate = "
+         << ratio(hits, hits + misses) * 100 << "%" << endl;
+#endif
+}
+
+} // namespace
@@ -0,0 +1,276 @@
+///
+/// @file  HugePageAllocator.cpp
+/// @brief Allocate large arrays using huge pages. We first try
+///        to allocate from the reserved huge pages (hugetlbfs)
+///        using mmap(MAP_HUGETLB). If this fails (usually no
+///        huge pages have been reserved) we allocate a 2 MiB
+///        aligned anonymous mapping and ask the kernel to back it
+///        by transparent huge pages using madvise(MADV_HUGEPAGE).
+///        Allocations smaller than one huge page are done using
+///        operator new. Each mmap allocation is recorded so that
+///        hugepage_free() releases it the way it was allocated,
+///        even if set_hugepages() has been called in between.
+///        Frees which cannot be mmap allocations (huge pages have
+///        never been enabled or fewer bytes than the smallest huge
+///        page) skip the lookup and its critical section.
+///
+/// Copyright (C) 2016 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <HugePageAllocator.hpp>
+#include <primecount-internal.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+
+#if defined(__linux__)
+  #include <sys/mman.h>
+  #include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace {
+
+enum PageType
+{
+  NO_ALLOCATION,
+  SMALL_PAGES,
+  TRANSPARENT_HUGE_PAGES,
+  HUGETLB_PAGES
+};
+
+bool hugepages_ = false;
+
+/// Huge page size in bytes
+size_t hugepage_size_ = 2 << 20;
+
+/// Only allocations of >= min_mmap_bytes_ may have been
+/// done using mmap, it is the smallest huge page size that
+/// has been enabled (or the maximum size_t).
+///
+size_t min_mmap_bytes_ = ~((size_t) 0);
+
+/// true if transparent huge pages are disabled
+bool thp_disabled_ = false;
+
+/// Page type of the large allocations, if huge pages
+/// could not be obtained for all large allocations this
+/// is the page type of the worst allocation.
+///
+PageType page_type_ = NO_ALLOCATION;
+
+/// mmap allocations: address -> mapped bytes
+map<void*, size_t> mappings_;
+
+void set_page_type(PageType type)
+{
+  #pragma omp critical (hugepages)
+  {
+    if (page_type_ == NO_ALLOCATION || type < page_type_)
+      page_type_ = type;
+  }
+}
+
+void add_mapping(void* ptr, size_t size)
+{
+  #pragma omp critical (hugepages)
+  mappings_[ptr] = size;
+}
+
+/// @return  The mapped bytes or 0 if ptr
+///          has been allocated using operator new.
+///
+size_t remove_mapping(void* ptr)
+{
+  size_t size = 0;
+
+  #pragma omp critical (hugepages)
+  {
+    map<void*, size_t>::iterator it = mappings_.find(ptr);
+    if (it != mappings_.end())
+    {
+      size = it->second;
+      mappings_.erase(it);
+    }
+  }
+
+  return size;
+}
+
+size_t round_up(size_t bytes, size_t size)
+{
+  return ((bytes + size - 1) / size) * size;
+}
+
+bool is_hugepage_alloc(size_t bytes)
+{
+  return hugepages_ && bytes >= hugepage_size_;
+}
+
+/// Get the base page size in bytes
+size_t get_base_page_size()
+{
+#if defined(__linux__) && defined(_SC_PAGESIZE)
+  long size = sysconf(_SC_PAGESIZE);
+  if (size > 0)
+    return (size_t) size;
+#endif
+  return 4 << 10;
+}
+
+/// Read the default huge page size from /proc/meminfo
+size_t get_hugepage_size()
+{
+  ifstream meminfo("/proc/meminfo");
+  string line;
+
+  while (getline(meminfo, line))
+  {
+    istringstream iss(line);
+    string key;
+    size_t kib = 0;
+
+    if (iss >> key >> kib && key == "Hugepagesize:" && kib > 0)
+      return kib << 10;
+  }
+
+  return 2 << 20;
+}
+
+bool is_thp_disabled()
+{
+  ifstream file("/sys/kernel/mm/transparent_hugepage/enabled");
+  string line;
+  getline(file, line);
+  return line.find("[never]") != string::npos;
+}
+
+} // namespace
+
+namespace primecount {
+
+/// Enable or disable huge pages.
+/// @warning Must be called before any table is allocated.
+///
+void set_hugepages(bool enable)
+{
+#if defined(__linux__) && defined(MAP_HUGETLB) && defined(MADV_HUGEPAGE)
+  hugepages_ = enable;
+  if (hugepages_)
+  {
+    hugepage_size_ = get_hugepage_size();
+    thp_disabled_ = is_thp_disabled();
+    min_mmap_bytes_ = min(min_mmap_bytes_, hugepage_size_);
+  }
+#else
+  unused_param(enable);
+#endif
+}
+
+bool is_hugepages()
+{
+  return hugepages_;
+}
+
+void* hugepage_alloc(size_t bytes)
+{
+  if (!is_hugepage_alloc(bytes))
+    return ::operator new(bytes);
+
+#if defined(__linux__) && defined(MAP_HUGETLB) && defined(MADV_HUGEPAGE)
+  size_t size = round_up(bytes, hugepage_size_);
+  void* ptr = mmap(0, size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+  if (ptr != MAP_FAILED)
+  {
+    set_page_type(HUGETLB_PAGES);
+    add_mapping(ptr, size);
+    return ptr;
+  }
+
+  // Transparent huge pages require a huge page aligned
+  // mapping, we allocate one huge page more and
+  // unmap the unaligned head and tail
+  size_t mapped = size + hugepage_size_;
+  ptr = mmap(0, mapped, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+  if (ptr == MAP_FAILED)
+    throw bad_alloc();
+
+  uintptr_t addr = (uintptr_t) ptr;
+  uintptr_t aligned = round_up(addr, hugepage_size_);
+  uintptr_t end = addr + mapped;
+
+  if (aligned > addr)
+    munmap(ptr, aligned - addr);
+  if (end > aligned + size)
+    munmap((void*) (aligned + size), end - (aligned + size));
+
+  if (!thp_disabled_ &&
+      madvise((void*) aligned, size, MADV_HUGEPAGE) == 0)
+    set_page_type(TRANSPARENT_HUGE_PAGES);
+  else
+    set_page_type(SMALL_PAGES);
+
+  add_mapping((void*) aligned, size);
+  return (void*) aligned;
+#else
+  return ::operator new(bytes);
+#endif
+}
+
+void hugepage_free(void* ptr, size_t bytes)
+{
+  if (bytes < min_mmap_bytes_)
+  {
+    ::operator delete(ptr);
+    return;
+  }
+
+  size_t size = remove_mapping(ptr);
+
+  if (!size)
+  {
+    ::operator delete(ptr);
+    return;
+  }
+
+#if defined(__linux__) && defined(MAP_HUGETLB) && defined(MADV_HUGEPAGE)
+  munmap(ptr, size);
+#endif
+}
+
+string get_page_size()
+{
+  ostringstream oss;
+  size_t mib = hugepage_size_ >> 20;
+  size_t kib = get_base_page_size() >> 10;
+
+  switch (page_type_)
+  {
+    case HUGETLB_PAGES:
+      oss << mib << " MiB (MAP_HUGETLB)"; break;
+    case TRANSPARENT_HUGE_PAGES:
+      oss << mib << " MiB (transparent huge pages)"; break;
+    case SMALL_PAGES:
+      oss << kib << " KiB (huge pages not available)"; break;
+    default:
+      oss << kib << " KiB (no table >= " << mib << " MiB)";
+  }
+
+  return oss.str();
+}
+
+} // namespace
@@ -0,0 +1,196 @@
+///
+/// @file  LeafDensity.cpp
+/// @brief Leaf-density model of the work of S2_hard(x, y), see
+///        LeafDensity.hpp. For a point t of the sieve interval
+///        [1, z] the sieving primes are the primes
+///        p_c < p <= min(sqrt(x / t), sqrt(z)), hence the
+///        cross-off work per integer is about
+///        sum 1 / p ~ log(log(P)) - log(log(p_c)). The hard
+///        special leaves n = p * m with x / n ~ t satisfy
+///        max(p_c, z / t) < p <= min(sqrt(x / t), sqrt(z)) and
+///        there are about x / (p * t^2) * d(m) of them for each
+///        prime p, with d(m) the density of the valid m. For
+///        p <= sqrt(y) m is a squarefree number whose smallest
+///        prime factor is > p, d(m) ~ e^-gamma / log(p). For
+///        p > sqrt(y) m is a prime <= z / p (hence t >= y),
+///        d(m) ~ 1 / log(x / (p * t)).
+///        Both sums over p have closed forms.
+///
+/// Copyright (C) 2016 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <LeafDensity.hpp>
+#include <pmath.hpp>
+#include <int128.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+const int64_t first_primes[] = { 2, 2, 3, 5, 7, 11, 13, 17, 19 };
+
+/// Grid points of the cumulative work in log(t)
+const int grid_size = 1024;
+
+/// Seconds per leaf / seconds per cross-off, measured
+/// on x86-64 for x = 10^15 (22) and x = 10^16 (29)
+///
+const double leaf_ratio = 25;
+
+} // namespace
+
+namespace primecount {
+
+LeafDensity::LeafDensity(maxint_t x, int64_t y, int64_t z, int64_t c) :
+  x_((double) x),
+  y_((double) y),
+  z_((double) z),
+  pc_((double) first_primes[in_between(0, c, 8)]),
+  work_(grid_size, 0),
+  done_(0),
+  ww_(0),
+  wt_(0)
+{
+  step_ = log(z_ + 1) / (grid_size - 1);
+  double old = sieve_density(1) + leaf_ratio * leaf_density(1);
+
+  // trapezoidal rule in log(t), dt = t * d(log(t))
+  for (int i = 1; i < grid_size; i++)
+  {
+    double t = exp(i * step_);
+    double work = (sieve_density(t) + leaf_ratio * leaf_density(t)) * t;
+    work_[i] = work_[i - 1] + (old + work) * step_ / 2;
+    old = work;
+  }
+}
+
+/// Cross-offs per integer at t
+double LeafDensity::sieve_density(double t) const
+{
+  double max_prime = min(sqrt(x_ / t), sqrt(z_));
+
+  if (max_prime <= pc_)
+    return 0;
+
+  return log(log(max_prime)) - log(log(pc_));
+}
+
+/// Hard special leaves per integer at t
+double LeafDensity::leaf_density(double t) const
+{
+  double low = max(pc_, z_ / t);
+  double high = min(sqrt(x_ / t), sqrt(z_));
+  double sqrty = sqrt(y_);
+  double sum = 0;
+
+  if (high <= low)
+    return 0;
+
+  // p <= sqrt(y), m squarefree and lpf(m) > p
+  double high1 = min(high, sqrty);
+  if (high1 > low)
+    sum += 0.5615 * (1 / log(low) - 1 / log(high1));
+
+  // p > sqrt(y), m prime and m <= z / p
+  double low2 = max(low, sqrty);
+  if (high > low2 && t >= y_)
+  {
+    double a = log(x_ / t);
+    double u1 = log(low2);
+    double u2 = log(high);
+    sum += (log(u2 / (a - u2)) - log(u1 / (a - u1))) / a;
+  }
+
+  return sum * (x_ / t) / t;
+}
+
+/// @return  Work of [1, t[
+double LeafDensity::cumulative(double t) const
+{
+  if (t <= 1)
+    return 0;
+
+  double pos = log(t) / step_;
+  int i = (int) pos;
+
+  if (i >= grid_size - 1)
+    return work_.back();
+
+  return work_[i] + (work_[i + 1] - work_[i]) * (pos - i);
+}
+
+/// @return  Work of [low, high[
+double LeafDensity::get_work(int64_t low, int64_t high) const
+{
+  return cumulative((double) high) - cumulative((double) low);
+}
+
+/// Least squares fit of seconds = work * seconds_per_work.
+/// The intervals below sqrt(z) contain no hard special
+/// leaves and their timings are dominated by the
+/// initialization, hence they are not used.
+///
+void LeafDensity::add(int64_t low, int64_t high, double seconds)
+{
+  double work = get_work(low, high);
+  done_ += work;
+
+  if (high > sqrt(z_))
+  {
+    ww_ += work * work;
+    wt_ += work * seconds;
+  }
+}
+
+void LeafDensity::skip(int64_t low, int64_t high)
+{
+  done_ += get_work(low, high);
+}
+
+double LeafDensity::percent() const
+{
+  if (work_.back() <= 0)
+    return 0;
+
+  return in_between(0, 100 * done_ / work_.back(), 100);
+}
+
+/// Binary search, the cumulative work is increasing
+int64_t LeafDensity::find_limit(double percent) const
+{
+  double work = work_.back() * in_between(0, percent, 100) / 100;
+  int64_t low = 1;
+  int64_t high = (int64_t) z_ + 1;
+
+  while (low < high)
+  {
+    int64_t mid = low + (high - low) / 2;
+    if (cumulative((double) mid) < work)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+
+  return low;
+}
+
+double LeafDensity::remaining_seconds() const
+{
+  if (ww_ <= 0)
+    return -1;
+
+  double seconds_per_work = wt_ / ww_;
+  double work = max(0.0, work_.back() - done_);
+
+  return work * seconds_per_work;
+}
+
+} // namespace
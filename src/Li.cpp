@@ -1,6 +1,7 @@
 ///
 /// @file  Li.cpp
-/// @brief Logarithmic integral approximation.
+/// @brief Logarithmic integral and Riemann R function
+///        approximations.
 ///
 /// Copyright (C) 2016 Kim Walisch, <kim.walisch@gmail.com>
 ///
@@ -98,6 +99,87 @@ T Li_inverse(T x)
   return first;
 }
 
+/// Calculate the Riemann zeta function for s >= 2 using
+/// the Euler-Maclaurin summation formula with N = 32.
+///
+long double zeta(int s)
+{
+  const int N = 32;
+  long double sum = 0;
+
+  for (int n = 1; n < N; n++)
+    sum += pow((long double) n, (long double) -s);
+
+  long double ns = pow((long double) N, (long double) -s);
+  sum += N * ns / (s - 1) + ns / 2;
+  sum += s * ns / (12 * N);
+  sum -= s * (s + 1.0L) * (s + 2.0L) * ns / (720.0L * N * N * N);
+
+  return sum;
+}
+
+/// Calculate the Riemann R function which is a very accurate
+/// approximation of the number of primes below x using the
+/// Gram series: R(x) = 1 + sum log(x)^k / (k * k! * zeta(k + 1)).
+/// All terms are positive, hence there is no cancellation.
+/// @see http://mathworld.wolfram.com/RiemannPrimeCountingFunction.html
+///
+long double R(long double x)
+{
+  long double logx = log(x);
+  long double sum = 1;
+  long double term = 1;
+
+  for (int k = 1; k < 10000; k++)
+  {
+    long double old_sum = sum;
+    term *= logx / k;
+    sum += term / (k * zeta(k + 1));
+    if (sum == old_sum)
+      break;
+  }
+
+  return sum;
+}
+
+template <typename T>
+T RiemannR(T x)
+{
+  if (x < 2)
+    return 0;
+
+  return (T) R((long double) x);
+}
+
+/// Calculate the inverse Riemann R function R^-1(x) which is
+/// a very accurate approximation of the nth prime using
+/// Newton's method, R'(t) ~ 1 / log(t).
+/// @return  numeric_limits<T>::max() if R^-1(x) overflows
+///
+template <typename T>
+T RiemannR_inverse(T x)
+{
+  if (x < 1)
+    return 0;
+
+  long double n = (long double) x;
+  long double t = max(2.0L, n * log(n));
+  long double eps = numeric_limits<long double>::epsilon() * 4;
+
+  for (int i = 0; i < 100; i++)
+  {
+    long double delta = (R(t) - n) * log(t);
+    t = max(2.0L, t - delta);
+    if (fabs(delta) < max(1.0L, t * eps))
+      break;
+  }
+
+  if (t >= (long double) prt::numeric_limits<T>::max())
+    return prt::numeric_limits<T>::max();
+
+  return (T) t;
+}
+
 } // namespace Li
 } // namespace primecount
 
@@ -113,6 +195,16 @@ int64_t Li_inverse(int64_t x)
   return Li::Li_inverse(x);
 }
 
+int64_t RiemannR(int64_t x)
+{
+  return Li::RiemannR(x);
+}
+
+int64_t RiemannR_inverse(int64_t x)
+{
+  return Li::RiemannR_inverse(x);
+}
+
 #ifdef HAVE_INT128_T
 
 int128_t Li(int128_t x)
@@ -125,6 +217,16 @@ int128_t Li_inverse(int128_t x)
   return Li::Li_inverse(x);
 }
 
+int128_t RiemannR(int128_t x)
+{
+  return Li::RiemannR(x);
+}
+
+int128_t RiemannR_inverse(int128_t x)
+{
+  return Li::RiemannR_inverse(x);
+}
+
 #endif
 
 } // namespace primecount
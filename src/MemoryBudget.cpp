@@ -0,0 +1,277 @@
+///
+/// @file  MemoryBudget.cpp
+/// @brief Estimate the memory usage of the Deleglise-Rivat
+///        algorithm and fit it into the --max-memory budget.
+///        The memory usage is dominated by the lookup tables:
+///        S2_hard(x, y) uses a FactorTable up to y and a PiTable
+///        and primes up to z / sqrt(y), S2_easy(x, y) uses a
+///        PiTable and primes up to y. The tables of the different
+///        formulas are never allocated at the same time. A larger
+///        alpha increases y but decreases z / sqrt(y), hence the
+///        memory usage is minimal for some alpha between 1 and
+///        x^(1/6). The threads only use O(sqrt(z)) memory each.
+///        The table widths (uint16_t or uint32_t FactorTable,
+///        32-bit or 64-bit primes) depend on y, hence searching
+///        alpha also picks the narrowest tables which fit.
+///        P2(x, y) uses two primesieve iterators per thread and
+///        S1(x, y) uses the primes up to y. During batch pi(xs)
+///        the table store keeps the tables alive across the
+///        formulas, these are counted in addition.
+///
+///        The budget only applies to the Deleglise-Rivat
+///        algorithm (pi(x), nth_prime(n), --P2, --S1, --S2_*).
+///        The other algorithms e.g. --legendre and --lehmer,
+///        whose PhiCache uses up to 16 MiB per thread, refuse
+///        to start if --max-memory is used.
+///
+/// Copyright (C) 2016 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primecount-internal.hpp>
+#include <FactorTable.hpp>
+#include <PhiTiny.hpp>
+#include <TableCache.hpp>
+#include <numa.hpp>
+#include <pmath.hpp>
+#include <int128.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <string>
+
+using namespace std;
+using namespace primecount;
+
+namespace {
+
+int64_t max_memory_ = -1;
+
+/// Executable, primesieve's sieve buffers, stacks, ...
+const double base_memory = 8 << 20;
+
+/// Approximate number of primes <= n, Li(n) > pi(n)
+/// for n < 10^316 hence this never underestimates.
+///
+double prime_count(int64_t n)
+{
+  return (double) max(Li(n), (int64_t) 0);
+}
+
+/// Memory usage of tables which are replicated
+/// to each NUMA node if --numa is used.
+///
+double replicated(double bytes)
+{
+  int nodes = numa_nodes();
+  return (nodes > 1) ? bytes * (nodes + 1) : bytes;
+}
+
+/// Memory usage of a primesieve::iterator up to stop:
+/// its sieving primes <= sqrt(stop) and its buffer
+/// of at most 4 MiB of primes.
+///
+double iterator_memory(int64_t stop)
+{
+  double sieving_primes = prime_count(isqrt(stop)) * 8;
+  double buffer = min(sieving_primes, (double) (4 << 20));
+  return sieving_primes + buffer;
+}
+
+/// Memory usage of P2(x, y) in bytes
+double P2_memory(maxint_t x, int64_t z, int threads)
+{
+  int64_t sqrtx = (int64_t) isqrt(x);
+  double thread = iterator_memory(sqrtx) + iterator_memory(z);
+  return thread * threads;
+}
+
+/// Memory usage of S1(x, y) in bytes
+double S1_memory(maxint_t x, int64_t y)
+{
+  bool is_uint32 = (x <= numeric_limits<int64_t>::max() ||
+                    y <= numeric_limits<uint32_t>::max());
+
+  double prime_size = is_uint32 ? 4 : 8;
+  return prime_count(y) * prime_size;
+}
+
+/// Memory usage of S2_hard(x, y) in bytes
+double S2_hard_memory(maxint_t x, int64_t y, int64_t z, int64_t c, int threads)
+{
+  bool is_uint16 = (y <= FactorTable<uint16_t>::max());
+  bool is_64bit = (x <= numeric_limits<int64_t>::max());
+
+  double factor_size = is_uint16 ? 2 : 4;
+  double prime_size = (is_64bit || is_uint16) ? 4 : 8;
+  double wheel = use_wheel2310(c) ? 480.0 / 2310 : 48.0 / 210;
+
+  int64_t max_prime = z / isqrt(y);
+  int64_t sqrtz = isqrt(z);
+
+  double factors = y * wheel * factor_size;
+  double pi = max_prime / 64.0 * 16;
+  double primes = prime_count(max_prime) * prime_size;
+  double dividers = prime_count(y) * 16;
+  double tables = replicated(factors + pi + primes + dividers);
+
+  // BitSieve210, block counters and wheel of a segment
+  // size <= 2 * sqrt(z), the sieve only stores the
+  // numbers coprime to 210
+  double sieve = 2 * sqrtz * (48.0 / 210) / 8;
+  double thread = sieve + sieve / 8 + prime_count(sqrtz) * 16;
+
+  // phi & mu_sum of the up to 4 unmerged intervals
+  // per thread (max_unmerged) and phi_total
+  double intervals = prime_count(sqrtz) * (16 * threads * 4 + 8);
+
+  return tables + thread * threads + intervals;
+}
+
+/// Memory usage of the table store in bytes: the
+/// FactorTable, the PiTable and the primes (int64_t)
+/// up to max(y, z / sqrt(y)). This also covers the
+/// copy made when a table is added to the store.
+///
+double table_store_memory(int64_t y, int64_t z, int64_t c)
+{
+  bool is_uint16 = (y <= FactorTable<uint16_t>::max());
+  double factor_size = is_uint16 ? 2 : 4;
+  double wheel = use_wheel2310(c) ? 480.0 / 2310 : 48.0 / 210;
+  int64_t max_prime = max(y, z / isqrt(y));
+
+  double factors = y * wheel * factor_size;
+  double pi = max_prime / 64.0 * 16;
+  double primes = prime_count(max_prime) * 8;
+
+  return factors + pi + primes;
+}
+
+/// Memory usage of S2_easy(x, y) in bytes
+double S2_easy_memory(maxint_t x, int64_t y)
+{
+  bool is_uint32 = (x <= numeric_limits<int64_t>::max() ||
+                    y <= numeric_limits<uint32_t>::max());
+
+  double prime_size = is_uint32 ? 4 : 8;
+  double pi = y / 64.0 * 16;
+  double primes = prime_count(y) * prime_size;
+  double dividers = prime_count(y) * 16;
+
+  return replicated(pi + primes + dividers);
+}
+
+string to_mib(double bytes)
+{
+  ostringstream oss;
+  oss << (int64_t) (bytes / (1 << 20)) << " MiB";
+  return oss.str();
+}
+
+} // namespace
+
+namespace primecount {
+
+void set_max_memory(int64_t bytes)
+{
+  max_memory_ = bytes;
+}
+
+bool is_max_memory()
+{
+  return max_memory_ >= 0;
+}
+
+/// Estimate the peak memory usage of the
+/// Deleglise-Rivat algorithm in bytes.
+///
+double deleglise_rivat_memory(maxint_t x, double alpha, int threads)
+{
+  int64_t y = (int64_t) (iroot<3>(x) * alpha);
+  y = max(y, (int64_t) 1);
+  int64_t z = (int64_t) (x / y);
+  int64_t c = PhiTiny::get_c(y);
+
+  double memory = max(P2_memory(x, z, threads), S1_memory(x, y));
+  memory = max(memory, S2_hard_memory(x, y, z, c, threads));
+  memory = max(memory, S2_easy_memory(x, y));
+
+  if (is_table_store())
+    memory += table_store_memory(y, z, c);
+
+  return base_memory + memory;
+}
+
+/// If the Deleglise-Rivat algorithm does not fit into
+/// --max-memory using alpha, find the alpha closest to
+/// alpha which fits. Alpha factors close to the default
+/// alpha run fastest. If no alpha fits, return the
+/// alpha which uses the least memory.
+///
+double fit_memory_alpha(maxint_t x, double alpha)
+{
+  if (max_memory_ < 0 ||
+      deleglise_rivat_memory(x, alpha, 1) <= max_memory_)
+    return alpha;
+
+  double max_alpha = (double) iroot<6>(x);
+  double best_alpha = -1;
+  double best_distance = -1;
+  double min_alpha = alpha;
+  double min_memory = deleglise_rivat_memory(x, alpha, 1);
+  int steps = 1000;
+
+  for (int i = 0; i <= steps; i++)
+  {
+    double a = pow(max_alpha, (double) i / steps);
+    double distance = fabs(log(a / alpha));
+    double memory = deleglise_rivat_memory(x, a, 1);
+
+    if (memory <= max_memory_ &&
+        (best_distance < 0 || distance < best_distance))
+    {
+      best_alpha = a;
+      best_distance = distance;
+    }
+
+    if (memory < min_memory)
+    {
+      min_alpha = a;
+      min_memory = memory;
+    }
+  }
+
+  if (best_alpha < 0)
+    return min_alpha;
+
+  return best_alpha;
+}
+
+/// @return  The largest number of threads <= threads for
+///          which the Deleglise-Rivat algorithm fits
+///          into --max-memory.
+/// @throw   primecount_error if it does not fit.
+///
+int fit_memory_threads(maxint_t x, double alpha, int threads)
+{
+  if (max_memory_ < 0)
+    return threads;
+
+  double memory = deleglise_rivat_memory(x, alpha, 1);
+
+  if (memory > max_memory_)
+    throw primecount_error("--max-memory is too small, needs at least " + to_mib(memory));
+
+  while (threads > 1 &&
+         deleglise_rivat_memory(x, alpha, threads) > max_memory_)
+    threads--;
+
+  return threads;
+}
+
+} // namespace
@@ -13,6 +13,8 @@
 #include <primecount-internal.hpp>
 #include <primesieve.hpp>
 #include <aligned_vector.hpp>
+#include <EventCounters.hpp>
+#include <PerfCounters.hpp>
 #include <int128.hpp>
 #include <min_max.hpp>
 #include <pmath.hpp>
@@ -74,7 +76,8 @@ T P2_OpenMP_thread(T x,
                    int64_t thread_num,
                    int64_t low,
                    int64_t& pix,
-                   int64_t& pix_count)
+                   int64_t& pix_count,
+                   EventCounters& events)
 {
   pix = 0;
   pix_count = 0;
@@ -101,6 +104,8 @@ T P2_OpenMP_thread(T x,
   }
 
   pix += count_primes(it, next, z - 1);
+  COUNT_EVENT(events, P2_PRIMES, pix);
+  COUNT_EVENT(events, P2_SUMS, pix_count);
 
   return P2_thread;
 }
@@ -147,7 +152,12 @@ T P2_OpenMP_master(T x, int64_t y, int threads)
 
     #pragma omp parallel for num_threads(threads) reduction(+: p2)
     for (int i = 0; i < threads; i++)
-      p2 += P2_OpenMP_thread(x, y, z, thread_distance, i, low, pix[i], pix_counts[i]);
+    {
+      PerfCounters perf;
+      EventCounters events;
+      p2 += P2_OpenMP_thread(x, y, z, thread_distance, i, low, pix[i], pix_counts[i], events);
+      events.merge();
+    }
 
     low += thread_distance * threads;
     balanceLoad(&thread_distance, low, z, threads, time);
@@ -193,6 +203,47 @@ int64_t P2(int64_t x, int64_t y, int threads)
   return p2;
 }
 
+/// Time P2(x, y) over one segment per thread in the middle
+/// of [2, z[ and extrapolate the seconds of the whole P2(x, y).
+/// Its run time is roughly proportional to z as it is
+/// dominated by sieving the primes < z.
+/// Used by primecount --tune.
+///
+double P2_sample_seconds(int64_t x, int64_t y, int threads)
+{
+  double time = get_wtime();
+  int64_t z = x / max(y, (int64_t) 1);
+  int64_t thread_distance = 1 << 23;
+
+  // too small to sample
+  if (z - 2 < thread_distance * threads * 4)
+  {
+    P2_OpenMP_master(x, y, threads);
+    return get_wtime() - time;
+  }
+
+  pi_legendre(y, threads);
+  pi_legendre(isqrt(x), threads);
+  double init = get_wtime() - time;
+
+  int64_t low = 2 + (z - 2) / 2;
+  time = get_wtime();
+
+  #pragma omp parallel for num_threads(threads)
+  for (int i = 0; i < threads; i++)
+  {
+    int64_t pix = 0;
+    int64_t pix_count = 0;
+    EventCounters events;
+    P2_OpenMP_thread(x, y, z, thread_distance, i, low, pix, pix_count, events);
+  }
+
+  double seconds = get_wtime() - time;
+  double segments = (double) (z - 2) / (thread_distance * threads);
+
+  return init + seconds * segments;
+}
+
 #ifdef HAVE_INT128_T
 
 int128_t P2(int128_t x, int64_t y, int threads)
@@ -0,0 +1,295 @@
+///
+/// @file  PerfCounters.cpp
+/// @brief Hardware performance counters using Linux'
+///        perf_event_open(2), see PerfCounters.hpp. The events
+///        are opened individually (not as a group) so that the
+///        supported events are counted even if some events are
+///        not available. If the kernel multiplexes the events
+///        the counts are scaled by time enabled / time running.
+///
+/// Copyright (C) 2016 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <PerfCounters.hpp>
+#include <print.hpp>
+
+#include <stdint.h>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+
+#if defined(__linux__)
+  #include <linux/perf_event.h>
+  #include <sys/ioctl.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
+
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
+using namespace std;
+using namespace primecount;
+
+namespace {
+
+bool perf_ = false;
+
+/// Counts of the threads which finished since
+/// the last call to add_perf_stage()
+///
+map<int, PerfValues> pending_;
+
+map<string, PerfValues> stages_;
+
+const char* names[NUM_PERF_EVENTS] =
+{
+  "cycles",
+  "instructions",
+  "L1d-misses",
+  "LLC-misses",
+  "dTLB-misses",
+  "branch-misses"
+};
+
+#if defined(__linux__)
+
+uint64_t cache_event(uint64_t cache)
+{
+  return cache |
+         (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+         (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+
+/// Open a counter of the calling thread
+/// @return  File descriptor or -1
+///
+int perf_open(int event)
+{
+  perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED |
+                     PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+  switch (event)
+  {
+    case PERF_CYCLES:
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = PERF_COUNT_HW_CPU_CYCLES; break;
+    case PERF_INSTRUCTIONS:
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = PERF_COUNT_HW_INSTRUCTIONS; break;
+    case PERF_L1D_MISSES:
+      attr.type = PERF_TYPE_HW_CACHE;
+      attr.config = cache_event(PERF_COUNT_HW_CACHE_L1D); break;
+    case PERF_LLC_MISSES:
+      attr.type = PERF_TYPE_HW_CACHE;
+      attr.config = cache_event(PERF_COUNT_HW_CACHE_LL); break;
+    case PERF_DTLB_MISSES:
+      attr.type = PERF_TYPE_HW_CACHE;
+      attr.config = cache_event(PERF_COUNT_HW_CACHE_DTLB); break;
+    case PERF_BRANCH_MISSES:
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = PERF_COUNT_HW_BRANCH_MISSES; break;
+  }
+
+  // pid = 0 and cpu = -1 counts the calling thread
+  int fd = (int) syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+
+  if (fd != -1)
+  {
+    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+  }
+
+  return fd;
+}
+
+/// @return  Count of the event scaled if multiplexed or -1
+int64_t perf_read(int fd)
+{
+  // value, time enabled, time running
+  uint64_t data[3];
+
+  ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+
+  if (read(fd, data, sizeof(data)) != (ssize_t) sizeof(data))
+    return -1;
+  if (data[2] == 0)
+    return 0;
+  if (data[2] < data[1])
+    return (int64_t) (data[0] * ((double) data[1] / data[2]));
+
+  return (int64_t) data[0];
+}
+
+#endif
+
+void print_value(int64_t value, int width)
+{
+  if (value < 0)
+    cout << setw(width) << "n/a";
+  else
+    cout << setw(width) << value;
+}
+
+void print_row(const string& thread, const PerfValues& perf)
+{
+  cout << setw(8) << thread;
+
+  for (int i = 0; i < NUM_PERF_EVENTS; i++)
+    print_value(perf.values[i], 15);
+
+  int64_t cycles = perf.values[PERF_CYCLES];
+  int64_t instructions = perf.values[PERF_INSTRUCTIONS];
+
+  if (cycles > 0 && instructions >= 0)
+    cout << setw(7) << fixed << setprecision(2) << (double) instructions / cycles;
+  else
+    cout << setw(7) << "n/a";
+
+  cout << endl;
+}
+
+void print_stage(const string& name, const PerfValues& total)
+{
+  cout << "Perf events " << name << ":" << endl;
+  cout << setw(8) << "thread";
+
+  for (int i = 0; i < NUM_PERF_EVENTS; i++)
+    cout << setw(15) << names[i];
+
+  cout << setw(7) << "IPC" << endl;
+
+  for (map<int, PerfValues>::iterator it = pending_.begin(); it != pending_.end(); ++it)
+  {
+    ostringstream thread;
+    thread << it->first;
+    print_row(thread.str(), it->second);
+  }
+
+  print_row("total", total);
+}
+
+} // namespace
+
+namespace primecount {
+
+PerfValues::PerfValues()
+{
+  for (int i = 0; i < NUM_PERF_EVENTS; i++)
+    values[i] = 0;
+}
+
+PerfValues& PerfValues::operator+=(const PerfValues& other)
+{
+  for (int i = 0; i < NUM_PERF_EVENTS; i++)
+  {
+    if (values[i] < 0 || other.values[i] < 0)
+      values[i] = -1;
+    else
+      values[i] += other.values[i];
+  }
+
+  return *this;
+}
+
+PerfCounters::PerfCounters()
+  : thread_num_(0)
+{
+  for (int i = 0; i < NUM_PERF_EVENTS; i++)
+    fds_[i] = -1;
+
+  if (!perf_)
+    return;
+
+#ifdef _OPENMP
+  thread_num_ = omp_get_thread_num();
+#endif
+
+#if defined(__linux__)
+  for (int i = 0; i < NUM_PERF_EVENTS; i++)
+    fds_[i] = perf_open(i);
+#endif
+}
+
+PerfCounters::~PerfCounters()
+{
+  if (!perf_)
+    return;
+
+  PerfValues perf;
+
+  for (int i = 0; i < NUM_PERF_EVENTS; i++)
+  {
+    perf.values[i] = -1;
+
+#if defined(__linux__)
+    if (fds_[i] != -1)
+    {
+      perf.values[i] = perf_read(fds_[i]);
+      close(fds_[i]);
+    }
+#endif
+  }
+
+  #pragma omp critical (PerfCounters)
+  pending_[thread_num_] += perf;
+}
+
+void set_perf(bool enable)
+{
+  perf_ = enable;
+}
+
+bool is_perf()
+{
+  return perf_;
+}
+
+const char* perf_event_name(int event)
+{
+  return names[event];
+}
+
+void add_perf_stage(const string& name)
+{
+  if (!perf_ || pending_.empty())
+    return;
+
+  PerfValues total;
+
+  for (map<int, PerfValues>::iterator it = pending_.begin(); it != pending_.end(); ++it)
+    total += it->second;
+
+  stages_[name] += total;
+
+  if (print_status())
+    print_stage(name, total);
+
+  pending_.clear();
+}
+
+map<string, PerfValues> get_perf_stages()
+{
+  return stages_;
+}
+
+void reset_perf()
+{
+  pending_.clear();
+  stages_.clear();
+}
+
+} // namespace
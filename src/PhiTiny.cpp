@@ -2,11 +2,18 @@
 /// @file  PhiTiny.cpp
 /// @brief phi_tiny(x, a) calculates the partial sieve function in
 ///        constant time (using lookup tables) for small values of
-///        a <= 6 using the formula below:
+///        a <= 8 using the formula below:
 ///
 ///        phi(x, a) = (x / pp) * φ(pp) + phi(x % pp, a)
 ///        with pp = 2 * 3 * ... * prime[a]
 ///
+///        For a <= 6 phi(x % pp, a) is stored in int16_t lookup
+///        tables. For a = 7 and a = 8 (pp = 510510 and 9699690)
+///        such tables would use up to 39 megabytes, hence we
+///        only store a bitmap of the odd numbers < pp / 2 that
+///        are coprime to pp together with the count of 1 bits
+///        before each 64-bit word (455 kilobytes for a = 8).
+///
 /// Copyright (C) 2016 Kim Walisch, <kim.walisch@gmail.com>
 ///
 /// This file is distributed under the BSD License. See the COPYING
@@ -15,8 +22,10 @@
 
 #include <PhiTiny.hpp>
 #include <int128.hpp>
+#include <popcount.hpp>
 
 #include <stdint.h>
+#include <cstddef>
 #include <vector>
 
 namespace primecount {
@@ -25,20 +34,20 @@ extern const PhiTiny phiTiny = PhiTiny();
 
 const int PhiTiny::pi[20] = { 0, 0, 1, 2, 2, 3, 3, 4, 4, 4, 4, 5, 5, 6, 6, 6, 6, 7, 7, 8 };
 
-const int PhiTiny::primes[7] = { 0, 2, 3, 5, 7, 11, 13 };
+const int PhiTiny::primes[9] = { 0, 2, 3, 5, 7, 11, 13, 17, 19 };
 
 /// prime_products[n] = \prod_{i=1}^{n} primes[i]
-const int PhiTiny::prime_products[7] = { 1, 2, 6, 30, 210, 2310, 30030 };
+const int PhiTiny::prime_products[9] = { 1, 2, 6, 30, 210, 2310, 30030, 510510, 9699690 };
 
 /// totients[n] = \prod_{i=1}^{n} (primes[i] - 1)
-const int PhiTiny::totients[7] = { 1, 1, 2, 8, 48, 480, 5760 };
+const int PhiTiny::totients[9] = { 1, 1, 2, 8, 48, 480, 5760, 92160, 1658880 };
 
 PhiTiny::PhiTiny()
 {
   phi_cache_[0].push_back(0);
 
   // Initialize the phi_cache_ lookup tables
-  for (int a = 1; a <= max_a(); a++)
+  for (int a = 1; a <= max_cache_a; a++)
   {
     int size = prime_products[a];
     std::vector<int16_t>& cache = phi_cache_[a];
@@ -50,6 +59,30 @@ PhiTiny::PhiTiny()
       cache.push_back((int16_t) phi_xa);
     }
   }
+
+  // Initialize the compressed phi_bitmap_ tables,
+  // bit i corresponds to the odd number 2 * i + 1
+  for (int a = max_cache_a + 1; a <= max_a(); a++)
+  {
+    uint64_t size = prime_products[a] / 4 + 1;
+    std::vector<uint64_t>& bitmap = phi_bitmap_[a];
+    std::vector<uint32_t>& counts = phi_counts_[a];
+    bitmap.resize(size / 64 + 1, ~((uint64_t) 0));
+    counts.resize(bitmap.size());
+
+    // unset the odd multiples of the first a primes
+    for (int i = 2; i <= a; i++)
+      for (uint64_t n = primes[i]; n < size * 2; n += primes[i] * 2)
+        bitmap[n / 128] &= ~(((uint64_t) 1) << (n / 2 % 64));
+
+    uint32_t count = 0;
+
+    for (std::size_t i = 0; i < bitmap.size(); i++)
+    {
+      counts[i] = count;
+      count += (uint32_t) popcount_u64(bitmap[i]);
+    }
+  }
 }
 
 } // namespace
@@ -9,30 +9,80 @@
 ///
 
 #include <PiTable.hpp>
+#include <primecount-internal.hpp>
 #include <primesieve.hpp>
+#include <pmath.hpp>
 
 #include <stdint.h>
+#include <algorithm>
 #include <vector>
 
+using namespace std;
+
 namespace primecount {
 
-PiTable::PiTable(uint64_t max) :
+/// Each thread sieves the primes of a segment whose size is a
+/// multiple of 64 so that no two threads write to the same
+/// PiData element. Then each thread computes the prime counts
+/// of its segment using the prime counts of the previous
+/// segments (prefix sum).
+///
+PiTable::PiTable(uint64_t max, int threads) :
   max_(max)
 {
-  pi_.resize(max / 64 + 1);
-  primesieve::iterator it(0, max);
+  if (pi_.load(cache_name(), max, table_size))
+    return;
+
+  int64_t size = max / 64 + 1;
+  pi_.resize(size);
+
+  int64_t thread_threshold = ipow(10, 7);
+  threads = ideal_num_threads(threads, max, thread_threshold);
+  int64_t thread_size = ceil_div(size, threads);
+  vector<uint64_t> counts(threads, 0);
+
+  #pragma omp parallel for num_threads(threads)
+  for (int t = 0; t < threads; t++)
+  {
+    int64_t start = thread_size * t;
+    int64_t stop = min(start + thread_size, size);
+    uint64_t low = start * 64;
+    uint64_t high = min(stop * 64 - 1, (int64_t) max);
 
-  uint64_t pix = 0;
-  uint64_t prime = 0;
+    if (start < stop)
+    {
+      primesieve::iterator it(low, high);
+      uint64_t prime = 0;
+      uint64_t count = 0;
 
-  while ((prime = it.next_prime()) <= max)
-    pi_[prime / 64].bits |= ((uint64_t) 1) << (prime % 64);
+      while ((prime = it.next_prime()) <= high)
+        pi_[prime / 64].bits |= ((uint64_t) 1) << (prime % 64);
 
-  for (uint64_t i = 0; i < pi_.size(); i++)
+      for (int64_t i = start; i < stop; i++)
+        count += popcount_u64(pi_[i].bits);
+
+      counts[t] = count;
+    }
+  }
+
+  #pragma omp parallel for num_threads(threads)
+  for (int t = 0; t < threads; t++)
   {
-    pi_[i].prime_count = pix;
-    pix += popcount_u64(pi_[i].bits);
+    int64_t start = thread_size * t;
+    int64_t stop = min(start + thread_size, size);
+    uint64_t pix = 0;
+
+    for (int i = 0; i < t; i++)
+      pix += counts[i];
+
+    for (int64_t i = start; i < stop; i++)
+    {
+      pi_[i].prime_count = pix;
+      pix += popcount_u64(pi_[i].bits);
+    }
   }
+
+  pi_.save(cache_name(), max, table_size);
 }
 
 } // namespace
@@ -0,0 +1,428 @@
+///
+/// @file  ResultCache.cpp
+/// @brief Persistent on-disk cache of pi(x) results, see
+///        ResultCache.hpp. The result cache file is read once
+///        into a sorted map, new results are appended to the
+///        file. A crash while appending may leave a truncated
+///        last line, hence each line is validated (newline
+///        terminated, checksum, pi(x) <= x) and invalid lines
+///        are skipped. The result cache is thread safe, all
+///        accesses are guarded by the critical section
+///        result_cache. On POSIX systems appends are also
+///        serialized across processes using an fcntl() lock on
+///        the result cache file. The gap between x and the nearest cached x0
+///        is only sieved if it is <= set_result_distance() or,
+///        by default, if sieving the gap is expected to be faster
+///        than computing pi(x), see is_sieve_gap().
+///
+/// Copyright (C) 2016 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <ResultCache.hpp>
+#include <primecount.hpp>
+#include <primecount-internal.hpp>
+#include <int128.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+  #include <fcntl.h>
+  #include <unistd.h>
+  #define HAVE_FCNTL
+#endif
+
+using namespace std;
+using namespace primecount;
+
+namespace {
+
+const string results_header = "primecount-results";
+
+/// Increase if the file format changes
+const int results_version = 2;
+
+string result_file_;
+
+int64_t result_distance_ = -1;
+
+/// Cached x -> pi(x)
+map<maxint_t, maxint_t> results_;
+
+bool loaded_ = false;
+
+/// FNV-1a hash of str
+string checksum(const string& str)
+{
+  uint32_t hash = 2166136261u;
+
+  for (size_t i = 0; i < str.size(); i++)
+  {
+    hash ^= (unsigned char) str[i];
+    hash *= 16777619u;
+  }
+
+  ostringstream oss;
+  oss << hex << setw(8) << setfill('0') << hash;
+  return oss.str();
+}
+
+bool is_digits(const string& str)
+{
+  if (str.empty() || str.size() > 40)
+    return false;
+
+  for (size_t i = 0; i < str.size(); i++)
+    if (!isdigit((unsigned char) str[i]))
+      return false;
+
+  return true;
+}
+
+string to_line(maxint_t x, maxint_t pix)
+{
+  ostringstream oss;
+  oss << x << " " << pix;
+  string record = oss.str();
+  return record + " " + checksum(record);
+}
+
+/// Parse a "x pi(x) checksum" line
+/// @return false if the line is invalid
+///
+bool parse_line(const string& line, maxint_t* x, maxint_t* pix)
+{
+  istringstream iss(line);
+  string x_str, pix_str, sum, rest;
+
+  if (!(iss >> x_str >> pix_str >> sum) ||
+      iss >> rest ||
+      !is_digits(x_str) ||
+      !is_digits(pix_str) ||
+      sum != checksum(x_str + " " + pix_str))
+    return false;
+
+  // too large for maxint_t
+  try
+  {
+    *x = to_maxint(x_str);
+    *pix = to_maxint(pix_str);
+  }
+  catch (exception&)
+  {
+    return false;
+  }
+
+  return *pix <= *x;
+}
+
+/// Exclusive lock of the result cache file, other primecount
+/// processes block until the lock is released. The lock is
+/// advisory and a no-op on systems without fcntl().
+///
+class FileLock
+{
+public:
+  FileLock(const string& filename)
+    : fd_(-1)
+  {
+#ifdef HAVE_FCNTL
+    fd_ = open(filename.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd_ != -1)
+    {
+      struct flock lock;
+      lock.l_type = F_WRLCK;
+      lock.l_whence = SEEK_SET;
+      lock.l_start = 0;
+      lock.l_len = 0;
+
+      while (fcntl(fd_, F_SETLKW, &lock) == -1)
+      {
+        if (errno != EINTR)
+        {
+          close(fd_);
+          fd_ = -1;
+          break;
+        }
+      }
+    }
+#endif
+  }
+
+  ~FileLock()
+  {
+#ifdef HAVE_FCNTL
+    // closing the file releases the lock
+    if (fd_ != -1)
+      close(fd_);
+#endif
+  }
+
+  bool is_locked() const
+  {
+#ifdef HAVE_FCNTL
+    return fd_ != -1;
+#else
+    return true;
+#endif
+  }
+private:
+  int fd_;
+};
+
+/// @return  false if the file does not exist or if its
+///          first (header) line is empty.
+///
+bool has_header(istream& in)
+{
+  string line;
+  return in && getline(in, line) && !line.empty();
+}
+
+bool has_header(const string& filename)
+{
+  ifstream in(filename.c_str(), ios::binary);
+  return has_header(in);
+}
+
+/// Exceptions must not leave a critical section,
+/// hence errors are returned instead of thrown.
+/// @pre Called inside critical (result_cache)
+/// @return false if the file has an invalid header
+///
+bool load_results()
+{
+  if (loaded_)
+    return true;
+
+  ifstream in(result_file_.c_str(), ios::binary);
+  string line;
+
+  // new or empty file, the header is
+  // (re)written by result_cache_add()
+  if (!has_header(in))
+  {
+    loaded_ = true;
+    return true;
+  }
+
+  in.clear();
+  in.seekg(0);
+  getline(in, line);
+
+  istringstream iss(line);
+  string header;
+  int version = 0;
+
+  if (!(iss >> header >> version) ||
+      header != results_header ||
+      version != results_version)
+    return false;
+
+  loaded_ = true;
+
+  // getline() hits eof on a line without newline,
+  // which has been truncated by a crash
+  while (getline(in, line) && !in.eof())
+  {
+    maxint_t x, pix;
+    if (parse_line(line, &x, &pix))
+      results_[x] = pix;
+  }
+
+  return true;
+}
+
+/// @return  true if the file does not end with
+///          a newline e.g. after a crash.
+///
+bool is_truncated(const string& filename)
+{
+  ifstream file(filename.c_str(), ios::binary | ios::ate);
+
+  if (!file || file.tellg() <= 0)
+    return false;
+
+  char c = 0;
+  file.seekg(-1, ios::end);
+  file.get(c);
+
+  return c != '\n';
+}
+
+/// @param distance  Maximum gap or -1 for the cost model.
+/// @return  true if the primes between
+///          x0 and x should be sieved.
+///
+bool is_near(maxint_t x0, maxint_t x, int64_t distance)
+{
+  maxint_t a = min(x0, x) + 1;
+  maxint_t b = max(x0, x);
+
+  if (b > numeric_limits<int64_t>::max())
+    return false;
+  if (distance >= 0)
+    return b - a + 1 <= distance;
+
+  return is_sieve_gap(a, b);
+}
+
+} // namespace
+
+namespace primecount {
+
+void set_result_cache(const string& filename)
+{
+  #pragma omp critical (result_cache)
+  {
+    result_file_ = filename;
+    results_.clear();
+    loaded_ = false;
+  }
+}
+
+void set_result_distance(int64_t distance)
+{
+  #pragma omp critical (result_cache)
+  result_distance_ = distance;
+}
+
+bool result_cache_find(maxint_t x, int threads, maxint_t* pix)
+{
+  bool is_valid = true;
+  bool found = false;
+  bool is_exact = false;
+  maxint_t x0 = 0;
+  maxint_t pix0 = 0;
+  int64_t distance = -1;
+  string filename;
+
+  #pragma omp critical (result_cache)
+  {
+    filename = result_file_;
+
+    if (!result_file_.empty() &&
+        (is_valid = load_results()))
+    {
+      map<maxint_t, maxint_t>::iterator it = results_.lower_bound(x);
+
+      // nearest cached x0 below or above x
+      if (it != results_.begin() &&
+          (it == results_.end() || it->first != x))
+      {
+        map<maxint_t, maxint_t>::iterator below = it;
+        --below;
+        if (it == results_.end() || x - below->first < it->first - x)
+          it = below;
+      }
+
+      if (it != results_.end())
+      {
+        found = true;
+        is_exact = (it->first == x);
+        x0 = it->first;
+        pix0 = it->second;
+        distance = result_distance_;
+      }
+    }
+  }
+
+  if (!is_valid)
+    throw primecount_error("invalid result cache file: " + filename);
+  if (!found)
+    return false;
+
+  if (is_exact)
+  {
+    print("Result cache: found pi(x)");
+    *pix = pix0;
+    return true;
+  }
+
+  if (!is_near(x0, x, distance))
+    return false;
+
+  ostringstream oss;
+  oss << "Result cache: sieve the gap to x0 = " << x0;
+  print(oss.str());
+
+  if (x0 < x)
+    *pix = pix0 + pi_primesieve((int64_t) x0 + 1, (int64_t) x, threads);
+  else
+    *pix = pix0 - pi_primesieve((int64_t) x + 1, (int64_t) x0, threads);
+
+  result_cache_add(x, *pix);
+
+  return true;
+}
+
+void result_cache_add(maxint_t x, maxint_t pix)
+{
+  bool is_valid = true;
+  bool is_error = false;
+  string filename;
+
+  #pragma omp critical (result_cache)
+  {
+    filename = result_file_;
+
+    if (!result_file_.empty() &&
+        (is_valid = load_results()))
+    {
+      if (!results_.count(x))
+      {
+        results_[x] = pix;
+        FileLock lock(result_file_);
+
+        // same test as in load_results(), a file without
+        // header is rewritten including all cached results
+        if (!lock.is_locked())
+          is_error = true;
+        else if (!has_header(result_file_))
+        {
+          ofstream out(result_file_.c_str(), ios::binary | ios::trunc);
+          out << results_header << " " << results_version << "\n";
+
+          map<maxint_t, maxint_t>::iterator it;
+          for (it = results_.begin(); it != results_.end(); ++it)
+            out << to_line(it->first, it->second) << "\n";
+
+          out.close();
+          is_error = !out;
+        }
+        else
+        {
+          bool truncated = is_truncated(result_file_);
+          ofstream out(result_file_.c_str(), ios::binary | ios::app);
+
+          // terminate the line truncated by a crash,
+          // it is skipped when loading the results
+          if (truncated)
+            out << "\n";
+
+          out << to_line(x, pix) << "\n";
+          out.close();
+          is_error = !out;
+        }
+      }
+    }
+  }
+
+  if (!is_valid)
+    throw primecount_error("invalid result cache file: " + filename);
+  if (is_error)
+    throw primecount_error("failed to write result cache file: " + filename);
+}
+
+} // namespace
@@ -14,6 +14,7 @@
 #include <primecount-internal.hpp>
 #include <PhiTiny.hpp>
 #include <generate.hpp>
+#include <PerfCounters.hpp>
 #include <pmath.hpp>
 
 #include <stdint.h>
@@ -70,11 +71,16 @@ X S1_OpenMP_master(X x,
   vector<Y> primes = generate_primes<Y>(y);
   X s1 = phi_tiny(x, c);
 
-  #pragma omp parallel for schedule(static, 1) num_threads(threads) reduction (+: s1)
-  for (int64_t b = c + 1; b < (int64_t) primes.size(); b++)
+  #pragma omp parallel num_threads(threads) reduction (+: s1)
   {
-    s1 += -1 * phi_tiny(x / primes[b], c);
-    s1 += S1_OpenMP_thread<1>(x, y, b, c, (X) primes[b], primes);
+    PerfCounters perf;
+
+    #pragma omp for schedule(static, 1)
+    for (int64_t b = c + 1; b < (int64_t) primes.size(); b++)
+    {
+      s1 += -1 * phi_tiny(x / primes[b], c);
+      s1 += S1_OpenMP_thread<1>(x, y, b, c, (X) primes[b], primes);
+    }
   }
 
   return s1;
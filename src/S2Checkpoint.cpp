@@ -0,0 +1,268 @@
+///
+/// @file  S2Checkpoint.cpp
+/// @brief Save and restore the state of S2_hard(x, y) so that
+///        long running computations can be resumed after a
+///        crash or a reboot. Requires use of the
+///        --checkpoint=<file> or --resume=<file> command-line
+///        options.
+///
+///        A checkpoint is only written after the finished intervals
+///        have been merged in order, hence it always contains a
+///        consistent state: all special leaves below low have been
+///        processed and phi_total contains the phi(low - 1, b)
+///        values. The checkpoint file is a plain text file which is
+///        first written to <file>.tmp and then renamed to <file> so
+///        that a crash during saving never corrupts the previous
+///        checkpoint.
+///
+///        The checkpoint file holds one section per x, hence
+///        batch pi(xs) and pi_range(a, b) which compute S2_hard for
+///        multiple x can be checkpointed and resumed too.
+///
+/// Copyright (C) 2016 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <S2Checkpoint.hpp>
+#include <S2LoadBalancer.hpp>
+#include <primecount.hpp>
+#include <primecount-internal.hpp>
+#include <int128.hpp>
+
+#include <stdint.h>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace primecount;
+
+namespace {
+
+const string checkpoint_header = "primecount-S2_hard-checkpoint";
+
+/// Increase if the file format changes,
+/// version 1 files have a single section.
+///
+const int checkpoint_version = 2;
+
+/// Minimum number of seconds between 2 checkpoints.
+/// Each save re-reads and rewrites the whole checkpoint file,
+/// i.e. pi(sqrt(z)) phi_total lines per x of a batch, while
+/// the merging thread is blocked (the other threads keep
+/// sieving). Hence the interval must not be too small.
+///
+const double checkpoint_interval = 60;
+
+string checkpoint_file_;
+
+string resume_file_;
+
+template <typename T>
+void read_value(istream& in, const string& key, T* value)
+{
+  string str;
+  if (!(in >> str) || str != key || !(in >> *value))
+    throw primecount_error("failed to read \"" + key + "\" from checkpoint file");
+}
+
+void read_value(istream& in, const string& key, maxint_t* value)
+{
+  string str;
+  read_value(in, key, &str);
+  *value = to_maxint(str);
+}
+
+/// Read the sections (x -> state) of a checkpoint file
+/// @return  false if the file does not exist
+///
+bool read_sections(const string& filename, map<string, string>& sections)
+{
+  ifstream in(filename.c_str());
+  if (!in)
+    return false;
+
+  int version = 0;
+  read_value(in, checkpoint_header, &version);
+  if (version < 1 || version > checkpoint_version)
+    throw primecount_error("unsupported checkpoint file version: " + filename);
+
+  string line;
+  string x;
+
+  while (getline(in, line))
+  {
+    if (line.compare(0, 2, "x ") == 0)
+      x = line.substr(2);
+    if (!x.empty())
+      sections[x] += line + "\n";
+  }
+
+  return true;
+}
+
+string to_string(maxint_t x)
+{
+  ostringstream oss;
+  oss << x;
+  return oss.str();
+}
+
+} // namespace
+
+namespace primecount {
+
+void set_checkpoint_file(const string& filename)
+{
+  checkpoint_file_ = filename;
+}
+
+void set_resume_file(const string& filename)
+{
+  resume_file_ = filename;
+}
+
+S2Checkpoint::S2Checkpoint(maxint_t x,
+                           int64_t y,
+                           int64_t z,
+                           int64_t c) :
+  x_(x),
+  y_(y),
+  z_(z),
+  c_(c),
+  last_save_(get_wtime())
+{
+  // after resuming continue saving to the same file
+  filename_ = checkpoint_file_;
+  if (filename_.empty())
+    filename_ = resume_file_;
+}
+
+bool S2Checkpoint::is_enabled() const
+{
+  return !filename_.empty();
+}
+
+void S2Checkpoint::disable()
+{
+  filename_.clear();
+}
+
+bool S2Checkpoint::load(int64_t* low,
+                        int64_t* segment_size,
+                        int64_t* segments_per_thread,
+                        maxint_t* s2_hard,
+                        vector<int64_t>& phi_total,
+                        S2LoadBalancer& loadBalancer)
+{
+  if (resume_file_.empty())
+    return false;
+
+  map<string, string> sections;
+  if (!read_sections(resume_file_, sections))
+    throw primecount_error("failed to open resume file: " + resume_file_);
+
+  // no state of this x yet, e.g. the
+  // next x of a batch pi(xs)
+  map<string, string>::iterator it = sections.find(to_string(x_));
+  if (it == sections.end())
+    return false;
+
+  istringstream in(it->second);
+  maxint_t x;
+  int64_t y, z, c;
+  read_value(in, "x", &x);
+  read_value(in, "y", &y);
+  read_value(in, "z", &z);
+  read_value(in, "c", &c);
+
+  if (x != x_ || y != y_ || z != z_ || c != c_)
+    throw primecount_error("resume file does not match x, y, z and c: " + resume_file_);
+
+  read_value(in, "low", low);
+  read_value(in, "segment_size", segment_size);
+  read_value(in, "segments_per_thread", segments_per_thread);
+  read_value(in, "s2_hard", s2_hard);
+  loadBalancer.load_state(in);
+
+  size_t size = 0;
+  read_value(in, "phi_total", &size);
+  if (size != phi_total.size())
+    throw primecount_error("resume file contains invalid phi_total: " + resume_file_);
+
+  for (size_t i = 0; i < size; i++)
+    if (!(in >> phi_total[i]))
+      throw primecount_error("resume file contains invalid phi_total: " + resume_file_);
+
+  ostringstream oss;
+  oss << "Resume S2_hard from " << resume_file_ << ", low = " << *low;
+  print(oss.str());
+
+  return true;
+}
+
+void S2Checkpoint::save(int64_t low,
+                        int64_t segment_size,
+                        int64_t segments_per_thread,
+                        maxint_t s2_hard,
+                        const vector<int64_t>& phi_total,
+                        const S2LoadBalancer& loadBalancer,
+                        bool force)
+{
+  if (!is_enabled())
+    return;
+
+  double time = get_wtime();
+  if (!force && time - last_save_ < checkpoint_interval)
+    return;
+
+  // keep the state of the other x
+  map<string, string> sections;
+  read_sections(filename_, sections);
+  ostringstream out;
+
+  out << "x " << x_ << "\n";
+  out << "y " << y_ << "\n";
+  out << "z " << z_ << "\n";
+  out << "c " << c_ << "\n";
+  out << "low " << low << "\n";
+  out << "segment_size " << segment_size << "\n";
+  out << "segments_per_thread " << segments_per_thread << "\n";
+  out << "s2_hard " << s2_hard << "\n";
+  loadBalancer.save_state(out);
+  out << "phi_total " << phi_total.size() << "\n";
+
+  for (size_t i = 0; i < phi_total.size(); i++)
+    out << phi_total[i] << "\n";
+
+  sections[to_string(x_)] = out.str();
+  string tmp_file = filename_ + ".tmp";
+  ofstream file(tmp_file.c_str());
+  file << checkpoint_header << " " << checkpoint_version << "\n";
+
+  for (map<string, string>::iterator it = sections.begin(); it != sections.end(); ++it)
+    file << it->second;
+
+  file.close();
+
+  if (!file)
+    throw primecount_error("failed to write checkpoint file: " + tmp_file);
+
+  // rename() is atomic on POSIX systems but
+  // fails on Windows if the file already exists
+  if (rename(tmp_file.c_str(), filename_.c_str()) != 0)
+  {
+    remove(filename_.c_str());
+    if (rename(tmp_file.c_str(), filename_.c_str()) != 0)
+      throw primecount_error("failed to write checkpoint file: " + filename_);
+  }
+
+  last_save_ = time;
+}
+
+} // namespace
@@ -48,6 +48,7 @@
 ///
 
 #include <S2LoadBalancer.hpp>
+#include <primecount.hpp>
 #include <primecount-internal.hpp>
 #include <aligned_vector.hpp>
 #include <pmath.hpp>
@@ -56,6 +57,8 @@
 #include <stdint.h>
 #include <algorithm>
 #include <cmath>
+#include <iostream>
+#include <string>
 
 using namespace std;
 using namespace primecount;
@@ -189,12 +192,17 @@ bool S2LoadBalancer::is_decrease(double seconds,
          rsd_ > pivot;
 }
 
+/// The segment size does not need to be a power of 2, it is
+/// rounded up to a multiple of 512 instead. This way the small
+/// segments at the start of the computation, which contain
+/// most special leaves, stay in the CPU's cache.
+///
 void S2LoadBalancer::update_min_size(double divisor)
 {
   int64_t min_size = 1 << 9;
   int64_t size = (int64_t) (sqrtz_ / max(1.0, divisor));
   min_size_ = max(size, min_size);
-  min_size_ = next_power_of_2(min_size_);
+  min_size_ = ceil_div(min_size_, min_size) * min_size;
 }
 
 /// Balance the load in the computation of the special leaves
@@ -247,6 +255,27 @@ void S2LoadBalancer::update(int64_t low,
   }
 }
 
+/// Write the state which changes during the computation
+/// (used by the S2_hard checkpoints).
+///
+void S2LoadBalancer::save_state(ostream& out) const
+{
+  out.precision(17);
+  out << "load_balancer " << rsd_ << " "
+                          << count_ << " "
+                          << total_seconds_ << " "
+                          << min_size_ << "\n";
+}
+
+void S2LoadBalancer::load_state(istream& in)
+{
+  string key;
+  in >> key >> rsd_ >> count_ >> total_seconds_ >> min_size_;
+
+  if (!in || key != "load_balancer")
+    throw primecount_error("failed to read S2LoadBalancer state");
+}
+
 /// Increase the segments_per_thread if the relative standard
 /// deviation of the thread run times is small, or
 /// decrease the segments_per_thread if the relative standard
@@ -10,10 +10,12 @@
 ///
 
 #include <S2Status.hpp>
+#include <LeafDensity.hpp>
 #include <primecount-internal.hpp>
 #include <pmath.hpp>
 #include <int128.hpp>
 
+#include <stdint.h>
 #include <algorithm>
 #include <cmath>
 #include <iostream>
@@ -27,6 +29,21 @@
 
 using namespace std;
 
+namespace {
+
+/// @return  hours:minutes:seconds
+string to_hms(double seconds)
+{
+  int64_t secs = (int64_t) (seconds + 0.5);
+  ostringstream hms;
+  hms << secs / 3600 << ":"
+      << setfill('0') << setw(2) << secs / 60 % 60 << ":"
+      << setfill('0') << setw(2) << secs % 60;
+  return hms.str();
+}
+
+} // namespace
+
 namespace primecount {
 
 S2Status::S2Status(maxint_t x) :
@@ -116,4 +133,35 @@ void S2Status::print(maxint_t n, maxint_t limit, double rsd)
   }
 }
 
+/// Print the percent of the estimated work of S2_hard that
+/// has been done and the estimated time of arrival, the
+/// remaining seconds of all threads / threads.
+///
+void S2Status::print(const LeafDensity& density, int threads, double rsd)
+{
+  double time = get_wtime();
+
+  if (is_print(time))
+  {
+    double percent = max(old_percent_, density.percent());
+    double seconds = density.remaining_seconds();
+    int load_balance = (int) in_between(0, 100 - rsd + 0.5, 100);
+
+    ostringstream status;
+    ostringstream out;
+
+    status << "Status: " << fixed << setprecision(precision_) << percent << "%, ";
+    if (seconds >= 0)
+      status << "ETA: " << to_hms(seconds / max(threads, 1)) << ", ";
+    status << "Load balance: " << load_balance << "%";
+    size_t spaces = status.str().length() + 2;
+    string reset_line = "\r" + string(spaces,' ') + "\r";
+    out << reset_line << status.str();
+    cout << out.str() << flush;
+
+    old_percent_ = percent;
+    old_time_ = time;
+  }
+}
+
 } //namespace
@@ -0,0 +1,483 @@
+///
+/// @file  TableCache.cpp
+/// @brief Read and write the cache files of the lookup tables.
+///        Cache files are first written to a temporary file
+///        which is then renamed, hence concurrent primecount
+///        processes never map a partially written cache file.
+///        Memory mapping is only supported on POSIX systems,
+///        on other systems the tables are always rebuilt.
+///        While the table store is enabled (batch pi(xs)) the
+///        tables are also kept in memory, a table of the store
+///        is used like a memory mapped cache file. The table
+///        store is thread safe, all accesses are guarded by
+///        the critical section table_store.
+///
+/// Copyright (C) 2016 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#if !defined(__STDC_CONSTANT_MACROS)
+  #define __STDC_CONSTANT_MACROS
+#endif
+
+#include <TableCache.hpp>
+#include <FactorTable.hpp>
+#include <PiTable.hpp>
+#include <primecount-internal.hpp>
+#include <generate.hpp>
+#include <pmath.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+  #define HAVE_MMAP
+#endif
+
+using namespace std;
+using namespace primecount;
+
+namespace primecount {
+
+struct StoredTable
+{
+  uint64_t type_size;
+  int64_t limit;
+  uint64_t size;
+  vector<char> data;
+  int references;
+};
+
+} // namespace
+
+namespace {
+
+/// Increment if the layout of any cached table
+/// or of the CacheHeader changes
+///
+const uint32_t CACHE_VERSION = 2;
+
+/// Detects cache files written on a system
+/// with a different byte order
+///
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+struct CacheHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint64_t type_size;
+  int64_t limit;
+  uint64_t size;
+  uint64_t checksum;
+};
+
+string cache_dir_;
+
+bool build_cache_ = false;
+
+/// Number of set_table_store(true) calls without
+/// matching set_table_store(false) call
+///
+int store_users_ = 0;
+
+/// The table store holds one reference of each of
+/// its tables, each MappedFile which maps a stored
+/// table holds another reference.
+///
+map<string, StoredTable*> store_;
+
+/// @pre Called inside critical (table_store)
+void release(StoredTable* table)
+{
+  if (--table->references == 0)
+    delete table;
+}
+
+const void* store_map(MappedFile& file,
+                      const string& name,
+                      size_t type_size,
+                      int64_t limit,
+                      uint64_t* size,
+                      int64_t* file_limit)
+{
+  StoredTable* table = 0;
+
+  #pragma omp critical (table_store)
+  {
+    map<string, StoredTable*>::iterator it = store_.find(name);
+
+    if (store_users_ > 0 &&
+        it != store_.end() &&
+        it->second->type_size == type_size &&
+        it->second->limit >= limit &&
+        it->second->size > 0)
+    {
+      table = it->second;
+      table->references++;
+    }
+  }
+
+  if (!table)
+    return 0;
+
+  file.share(table);
+  *size = table->size;
+  *file_limit = table->limit;
+  return &table->data[0];
+}
+
+/// Keep the table with the largest limit
+void store_save(const string& name,
+                size_t type_size,
+                int64_t limit,
+                const void* data,
+                uint64_t size)
+{
+  const char* bytes = (const char*) data;
+  StoredTable* table = new StoredTable;
+  table->type_size = type_size;
+  table->limit = limit;
+  table->size = size;
+  table->data.assign(bytes, bytes + type_size * size);
+  table->references = 1;
+
+  #pragma omp critical (table_store)
+  {
+    map<string, StoredTable*>::iterator it = store_.find(name);
+
+    if (store_users_ == 0)
+      release(table);
+    else if (it == store_.end())
+      store_[name] = table;
+    else if (it->second->type_size == type_size &&
+             it->second->limit >= limit)
+      release(table);
+    else
+    {
+      release(it->second);
+      it->second = table;
+    }
+  }
+}
+
+string get_filename(const string& name)
+{
+  return cache_dir_ + "/" + name + ".cache";
+}
+
+/// FNV-1a hash of the 64-bit words of data,
+/// detects corrupted and partially overwritten
+/// cache files.
+///
+uint64_t checksum(const void* data, uint64_t bytes)
+{
+  const char* ptr = (const char*) data;
+  uint64_t hash = UINT64_C(14695981039346656037);
+  uint64_t words = bytes / 8;
+
+  for (uint64_t i = 0; i < words; i++)
+  {
+    uint64_t word;
+    memcpy(&word, ptr + i * 8, 8);
+    hash = (hash ^ word) * UINT64_C(1099511628211);
+  }
+
+  for (uint64_t i = words * 8; i < bytes; i++)
+    hash = (hash ^ (uint8_t) ptr[i]) * UINT64_C(1099511628211);
+
+  return hash;
+}
+
+/// Sets build_cache_ for the lifetime of the
+/// object, the previous value is restored
+/// even if building a table throws.
+///
+class BuildCacheGuard
+{
+public:
+  BuildCacheGuard(bool enable)
+    : old_(build_cache_)
+  {
+    build_cache_ = enable;
+  }
+
+  ~BuildCacheGuard()
+  {
+    build_cache_ = old_;
+  }
+private:
+  bool old_;
+};
+
+void init_header(CacheHeader* header)
+{
+  memset(header, 0, sizeof(CacheHeader));
+  memcpy(header->magic, "PRIMECNT", 8);
+  header->version = CACHE_VERSION;
+  header->byte_order = BYTE_ORDER_MARK;
+}
+
+} // namespace
+
+namespace primecount {
+
+void set_cache_dir(const string& dir)
+{
+  cache_dir_ = dir;
+}
+
+void set_build_cache(bool enable)
+{
+  build_cache_ = enable;
+}
+
+bool is_build_cache()
+{
+  return build_cache_ && !cache_dir_.empty();
+}
+
+/// Enabling and disabling nest, concurrent batches share
+/// the table store. The tables are freed (once no longer
+/// mapped) when the last batch disables the table store.
+///
+void set_table_store(bool enable)
+{
+  #pragma omp critical (table_store)
+  {
+    if (enable)
+      store_users_++;
+    else if (store_users_ > 0)
+      store_users_--;
+
+    if (store_users_ == 0)
+    {
+      map<string, StoredTable*>::iterator it;
+      for (it = store_.begin(); it != store_.end(); ++it)
+        release(it->second);
+      store_.clear();
+    }
+  }
+}
+
+bool is_table_store()
+{
+  bool is_store;
+
+  #pragma omp critical (table_store)
+  is_store = store_users_ > 0;
+
+  return is_store;
+}
+
+MappedFile::MappedFile()
+  : data_(0),
+    size_(0),
+    table_(0)
+{ }
+
+MappedFile::~MappedFile()
+{
+  unmap();
+}
+
+bool MappedFile::map(const string& filename)
+{
+  unmap();
+
+#ifdef HAVE_MMAP
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd == -1)
+    return false;
+
+  struct stat st;
+  if (fstat(fd, &st) == 0 && st.st_size > 0)
+  {
+    void* ptr = mmap(0, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (ptr != MAP_FAILED)
+    {
+      data_ = (const char*) ptr;
+      size_ = (size_t) st.st_size;
+    }
+  }
+
+  close(fd);
+#else
+  unused_param(filename);
+#endif
+
+  return data_ != 0;
+}
+
+void MappedFile::share(StoredTable* table)
+{
+  unmap();
+  table_ = table;
+}
+
+void MappedFile::unmap()
+{
+  if (table_)
+  {
+    #pragma omp critical (table_store)
+    release(table_);
+    table_ = 0;
+  }
+
+#ifdef HAVE_MMAP
+  if (data_)
+    munmap((void*) data_, size_);
+#endif
+
+  data_ = 0;
+  size_ = 0;
+}
+
+const void* cache_map(MappedFile& file,
+                      const string& name,
+                      size_t type_size,
+                      int64_t limit,
+                      uint64_t* size,
+                      int64_t* file_limit)
+{
+  const void* data = store_map(file, name, type_size, limit, size, file_limit);
+  if (data)
+    return data;
+
+  if (cache_dir_.empty() ||
+      !file.map(get_filename(name)) ||
+      file.size() < sizeof(CacheHeader))
+    return 0;
+
+  CacheHeader expected;
+  CacheHeader header;
+  init_header(&expected);
+  memcpy(&header, file.data(), sizeof(CacheHeader));
+  const char* table = file.data() + sizeof(CacheHeader);
+  uint64_t bytes = file.size() - sizeof(CacheHeader);
+
+  // the file must contain exactly size elements
+  // and their checksum must match
+  if (memcmp(header.magic, expected.magic, 8) != 0 ||
+      header.version != expected.version ||
+      header.byte_order != expected.byte_order ||
+      header.type_size != type_size ||
+      header.limit < limit ||
+      header.size != bytes / type_size ||
+      bytes % type_size != 0 ||
+      header.checksum != checksum(table, bytes))
+  {
+    file.unmap();
+    return 0;
+  }
+
+  *size = header.size;
+  *file_limit = header.limit;
+  return table;
+}
+
+void cache_save(const string& name,
+                size_t type_size,
+                int64_t limit,
+                const void* data,
+                uint64_t size)
+{
+  if (is_table_store())
+    store_save(name, type_size, limit, data, size);
+
+  if (!is_build_cache())
+    return;
+
+  CacheHeader header;
+  init_header(&header);
+  header.type_size = type_size;
+  header.limit = limit;
+  header.size = size;
+  header.checksum = checksum(data, type_size * size);
+
+  string filename = get_filename(name);
+  string tmp = filename + ".tmp";
+  FILE* file = fopen(tmp.c_str(), "wb");
+
+  if (!file)
+    throw primecount_error("failed to create cache file " + tmp);
+
+  bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+            fwrite(data, type_size, (size_t) size, file) == size;
+
+  if (fclose(file) != 0 || !ok)
+  {
+    remove(tmp.c_str());
+    throw primecount_error("failed to write cache file " + tmp);
+  }
+
+  // rename() does not overwrite existing files on Windows
+  remove(filename.c_str());
+
+  if (rename(tmp.c_str(), filename.c_str()) != 0)
+    throw primecount_error("failed to write cache file " + filename);
+}
+
+int64_t cache_file_size(const string& name)
+{
+  ifstream file(get_filename(name).c_str(), ios::binary | ios::ate);
+  if (!file)
+    return 0;
+  return (int64_t) file.tellg();
+}
+
+/// Build the cache files of the lookup tables used by the
+/// Deleglise-Rivat algorithm with the parameters y, z, c.
+/// Tables which are already cached are not rebuilt.
+/// @return  The total size of the cache files in bytes.
+///
+int64_t build_cache(int64_t y, int64_t z, int64_t c, int threads)
+{
+  if (cache_dir_.empty())
+    throw primecount_error("no cache directory set");
+
+  BuildCacheGuard guard(true);
+
+  // S2_hard uses primes <= z / sqrt(y), the other
+  // formulas use primes <= y
+  int64_t max_prime = max(y, z / isqrt(y));
+  PiTable pi(max_prime, threads);
+  generate_primes<int64_t>(max_prime);
+
+  string factors;
+
+  if (y <= FactorTable<uint16_t>::max())
+  {
+    if (use_wheel2310(c))
+      factors = FactorTable<uint16_t, 2310>(y, threads).cache_name();
+    else
+      factors = FactorTable<uint16_t>(y, threads).cache_name();
+  }
+  else
+  {
+    if (use_wheel2310(c))
+      factors = FactorTable<uint32_t, 2310>(y, threads).cache_name();
+    else
+      factors = FactorTable<uint32_t>(y, threads).cache_name();
+  }
+
+  return cache_file_size(factors) +
+         cache_file_size(PiTable::cache_name()) +
+         cache_file_size("primes");
+}
+
+} // namespace
@@ -11,6 +11,7 @@
 
 #include "cmdoptions.hpp"
 #include <primecount-internal.hpp>
+#include <PerfCounters.hpp>
 #include <int128.hpp>
 
 #include <stdint.h>
@@ -59,6 +60,10 @@ void initOptionMap()
 {
   optionMap["-a"]                          = OPTION_ALPHA;
   optionMap["--alpha"]                     = OPTION_ALPHA;
+  optionMap["--benchmark"]                 = OPTION_BENCHMARK;
+  optionMap["--build-cache"]               = OPTION_BUILD_CACHE;
+  optionMap["--cache"]                     = OPTION_CACHE;
+  optionMap["--checkpoint"]                = OPTION_CHECKPOINT;
   optionMap["-d"]                          = OPTION_DELEGLISE_RIVAT;
   optionMap["--deleglise_rivat"]           = OPTION_DELEGLISE_RIVAT;
   optionMap["--deleglise_rivat1"]          = OPTION_DELEGLISE_RIVAT1;
@@ -68,6 +73,8 @@ void initOptionMap()
   optionMap["--deleglise_rivat_parallel3"] = OPTION_DELEGLISE_RIVAT_PARALLEL3;
   optionMap["-h"]                          = OPTION_HELP;
   optionMap["--help"]                      = OPTION_HELP;
+  optionMap["--hugepages"]                 = OPTION_HUGEPAGES;
+  optionMap["--json"]                      = OPTION_JSON;
   optionMap["--legendre"]                  = OPTION_LEGENDRE;
   optionMap["--lehmer"]                    = OPTION_LEHMER;
   optionMap["-l"]                          = OPTION_LMO;
@@ -82,15 +89,23 @@ void initOptionMap()
   optionMap["--lmo_parallel3"]             = OPTION_LMO_PARALLEL3;
   optionMap["--Li"]                        = OPTION_LI;
   optionMap["--Li_inverse"]                = OPTION_LIINV;
+  optionMap["--max-memory"]                = OPTION_MAX_MEMORY;
   optionMap["-m"]                          = OPTION_MEISSEL;
   optionMap["--meissel"]                   = OPTION_MEISSEL;
   optionMap["-n"]                          = OPTION_NTHPRIME;
   optionMap["--nthprime"]                  = OPTION_NTHPRIME;
+  optionMap["--numa"]                      = OPTION_NUMA;
   optionMap["--number"]                    = OPTION_NUMBER;
   optionMap["--P2"]                        = OPTION_P2;
+  optionMap["--perf"]                      = OPTION_PERF;
   optionMap["--pi"]                        = OPTION_PI;
   optionMap["-p"]                          = OPTION_PRIMESIEVE;
   optionMap["--primesieve"]                = OPTION_PRIMESIEVE;
+  optionMap["--range"]                     = OPTION_RANGE;
+  optionMap["--repeat"]                    = OPTION_REPEAT;
+  optionMap["--result-cache"]              = OPTION_RESULT_CACHE;
+  optionMap["--result-distance"]           = OPTION_RESULT_DISTANCE;
+  optionMap["--resume"]                    = OPTION_RESUME;
   optionMap["--S1"]                        = OPTION_S1;
   optionMap["--S2_easy"]                   = OPTION_S2_EASY;
   optionMap["--S2_hard"]                   = OPTION_S2_HARD;
@@ -101,8 +116,10 @@ void initOptionMap()
   optionMap["--time"]                      = OPTION_TIME;
   optionMap["-t"]                          = OPTION_THREADS;
   optionMap["--threads"]                   = OPTION_THREADS;
+  optionMap["--tune"]                      = OPTION_TUNE;
   optionMap["-v"]                          = OPTION_VERSION;
   optionMap["--version"]                   = OPTION_VERSION;
+  optionMap["--wheel"]                     = OPTION_WHEEL;
 }
 
 /// e.g. "--threads=8" -> { id = "--threads", value = "8" }
@@ -143,6 +160,24 @@ PrimeCountOptions parseOptions(int argc, char** argv)
       switch (optionMap[option.id])
       {
         case OPTION_ALPHA:   set_alpha(to_double(option.value)); break;
+        case OPTION_BENCHMARK: if (!option.value.empty())
+                                 numbers.push_back(option.getValue<maxint_t>());
+                               pco.option = OPTION_BENCHMARK;
+                               break;
+        case OPTION_BUILD_CACHE: set_cache_dir(option.value);
+                             pco.option = OPTION_BUILD_CACHE;
+                             break;
+        case OPTION_CACHE:   set_cache_dir(option.value); break;
+        case OPTION_MAX_MEMORY: set_max_memory((int64_t) to_maxint(option.value)); break;
+        case OPTION_CHECKPOINT: set_checkpoint_file(option.value); break;
+        case OPTION_RESUME:  set_resume_file(option.value); break;
+        case OPTION_RESULT_CACHE: set_result_cache(option.value); break;
+        case OPTION_RESULT_DISTANCE: set_result_distance((int64_t) to_maxint(option.value)); break;
+        case OPTION_JSON:    pco.json = option.value; break;
+        case OPTION_REPEAT:  pco.repeat = option.getValue<int>(); break;
+        case OPTION_NUMA:    set_numa(true); break;
+        case OPTION_HUGEPAGES: set_hugepages(true); break;
+        case OPTION_PERF:    set_perf(true); break;
         case OPTION_NUMBER:  numbers.push_back(option.getValue<maxint_t>()); break;
         case OPTION_THREADS: pco.threads = option.getValue<int>(); break;
         case OPTION_HELP:    help(); break;
@@ -153,7 +188,12 @@ PrimeCountOptions parseOptions(int argc, char** argv)
                              break;
         case OPTION_TIME:    pco.time = true; break;
         case OPTION_TEST:    if (test()) exit(0); exit(1);
+        case OPTION_TUNE:    if (!option.value.empty())
+                               numbers.push_back(option.getValue<maxint_t>());
+                             pco.option = OPTION_TUNE;
+                             break;
         case OPTION_VERSION: version(); break;
+        case OPTION_WHEEL:   set_wheel(option.getValue<int>()); break;
         default:             pco.option = optionMap[option.id];
       }
     }
@@ -163,7 +203,22 @@ PrimeCountOptions parseOptions(int argc, char** argv)
     help();
   }
 
-  if (numbers.size() == 1)
+  // default --tune limit
+  if (pco.option == OPTION_TUNE && numbers.empty())
+    numbers.push_back((maxint_t) 1e13);
+
+  // default --benchmark limit, a few minutes on a
+  // single core, larger x take hours or days
+  if (pco.option == OPTION_BENCHMARK && numbers.empty())
+    numbers.push_back((maxint_t) 1e16);
+
+  // primecount a b --range
+  if (pco.option == OPTION_RANGE && numbers.size() == 2)
+  {
+    pco.a = numbers[0];
+    pco.x = numbers[1];
+  }
+  else if (numbers.size() == 1)
     pco.x = numbers[0];
   else
     help();
@@ -14,11 +14,17 @@
 #include <int128.hpp>
 #include <stdint.h>
 
+#include <string>
+
 namespace primecount {
 
 enum OptionValues
 {
   OPTION_ALPHA,
+  OPTION_BENCHMARK,
+  OPTION_BUILD_CACHE,
+  OPTION_CACHE,
+  OPTION_CHECKPOINT,
   OPTION_DELEGLISE_RIVAT,
   OPTION_DELEGLISE_RIVAT1,
   OPTION_DELEGLISE_RIVAT2,
@@ -26,6 +32,8 @@ enum OptionValues
   OPTION_DELEGLISE_RIVAT_PARALLEL2,
   OPTION_DELEGLISE_RIVAT_PARALLEL3,
   OPTION_HELP,
+  OPTION_HUGEPAGES,
+  OPTION_JSON,
   OPTION_LEGENDRE,
   OPTION_LEHMER,
   OPTION_LMO,
@@ -39,12 +47,20 @@ enum OptionValues
   OPTION_LMO_PARALLEL3,
   OPTION_LI,
   OPTION_LIINV,
+  OPTION_MAX_MEMORY,
   OPTION_MEISSEL,
   OPTION_NTHPRIME,
+  OPTION_NUMA,
   OPTION_NUMBER,
   OPTION_P2,
+  OPTION_PERF,
   OPTION_PI,
   OPTION_PRIMESIEVE,
+  OPTION_RANGE,
+  OPTION_REPEAT,
+  OPTION_RESULT_CACHE,
+  OPTION_RESULT_DISTANCE,
+  OPTION_RESUME,
   OPTION_S1,
   OPTION_S2_EASY,
   OPTION_S2_HARD,
@@ -53,20 +69,28 @@ enum OptionValues
   OPTION_TEST,
   OPTION_TIME,
   OPTION_THREADS,
-  OPTION_VERSION
+  OPTION_TUNE,
+  OPTION_VERSION,
+  OPTION_WHEEL
 };
 
 struct PrimeCountOptions
 {
+  maxint_t a;
   maxint_t x;
   int64_t option;
   bool time;
   int threads;
+  int repeat;
+  std::string json;
   PrimeCountOptions() :
+    a(-1),
     x(-1),
     option(OPTION_PI),
     time(false),
-    threads(get_num_threads())
+    threads(get_num_threads()),
+    repeat(1),
+    json("primecount-benchmark.json")
   { }
 };
 
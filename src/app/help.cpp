@@ -24,7 +24,10 @@ const string helpMenu(
   "\n"
   "Options:\n"
   "\n"
+  "         --benchmark[=N]    Benchmark pi(10^12), pi(10^13), ..., pi(N) using\n"
+  "                            1, 2, 4, ... threads, N=1e16, see --repeat\n"
   "  -d,    --deleglise_rivat  Count primes using Deleglise-Rivat algorithm\n"
+  "         --json=<file>      Save the --benchmark results as JSON to <file>\n"
   "         --legendre         Count primes using Legendre's formula\n"
   "         --lehmer           Count primes using Lehmer's formula\n"
   "  -l,    --lmo              Count primes using Lagarias-Miller-Odlyzko\n"
@@ -33,11 +36,16 @@ const string helpMenu(
   "         --Li_inverse       Approximate the nth prime using Li^-1(x)\n"
   "  -n,    --nthprime         Calculate the nth prime\n"
   "  -p,    --primesieve       Count primes using the sieve of Eratosthenes\n"
+  "         --range            Count the primes inside [a, b], usage:\n"
+  "                            primecount a b --range\n"
+  "         --repeat=<N>       Repeat each --benchmark run N times\n"
   "  -s[N], --status[=N]       Show computation progress 1%, 2%, 3%, ...\n"
   "                            [N] digits after decimal point e.g. N=1, 99.9%\n"
   "         --test             Run various correctness tests and exit\n"
   "         --time             Print the time elapsed in seconds\n"
   "  -t<N>, --threads=<N>      Set the number of threads, 1 <= N <= CPU cores\n"
+  "         --tune[=N]         Find the fastest alpha factors for x <= N and\n"
+  "                            save them to ~/.primecount_alpha, N=1e13\n"
   "  -v,    --version          Print version and license information\n"
   "  -h,    --help             Print this help menu\n"
   "\n"
@@ -49,6 +57,25 @@ const string helpMenu(
   "         --S2_trivial       Only compute the trivial special leaves\n"
   "         --S2_easy          Only compute the easy special leaves\n"
   "         --S2_hard          Only compute the hard special leaves\n"
+  "         --checkpoint=<file>\n"
+  "                            Periodically save the S2_hard state to <file>\n"
+  "         --resume=<file>    Resume S2_hard from a checkpoint <file>\n"
+  "         --numa             Copy the lookup tables to each NUMA node (Linux)\n"
+  "         --hugepages        Allocate the lookup tables using huge pages (Linux)\n"
+  "         --wheel=<N>        FactorTable wheel, N=210 or N=2310 (default),\n"
+  "                            the 2310 wheel uses 9% less memory\n"
+  "         --cache=<dir>      Map the cached lookup tables from <dir>\n"
+  "         --build-cache=<dir>\n"
+  "                            Cache the lookup tables of pi(x) in <dir>\n"
+  "         --result-cache=<file>\n"
+  "                            Cache the pi(x) results in <file>, pi(x) of a\n"
+  "                            nearby x is computed by sieving the gap\n"
+  "         --result-distance=<N>\n"
+  "                            Maximum gap sieved using --result-cache\n"
+  "         --max-memory=<N>   Fit alpha and threads into N bytes of memory,\n"
+  "                            only supported by the Deleglise-Rivat algorithm\n"
+  "         --perf             Count CPU cycles, cache misses, ... using\n"
+  "                            perf_event_open (Linux), see --status\n"
   "\n"
   "Examples:\n"
   "\n"
@@ -11,6 +11,8 @@
 #include "cmdoptions.hpp"
 
 #include <primecount-internal.hpp>
+#include <EventCounters.hpp>
+#include <HugePageAllocator.hpp>
 #include <primecount.hpp>
 #include <pmath.hpp>
 #include <int128.hpp>
@@ -51,6 +53,8 @@ maxint_t P2(maxint_t x, int threads)
   if (x > to_maxint(limit))
     throw primecount_error("P2(x): x must be <= " + limit);
 
+  threads = fit_memory_threads(x, alpha, threads);
+
   if (print_status())
     set_print_variables(true);
 
@@ -73,6 +77,8 @@ maxint_t S1(maxint_t x, int threads)
   if (x > to_maxint(limit))
     throw primecount_error("S1(x): x must be <= " + limit);
 
+  threads = fit_memory_threads(x, alpha, threads);
+
   if (print_status())
     set_print_variables(true);
 
@@ -96,6 +102,8 @@ maxint_t S2_trivial(maxint_t x, int threads)
   if (x > to_maxint(limit))
     throw primecount_error("S2_trivial(x): x must be <= " + limit);
 
+  threads = fit_memory_threads(x, alpha, threads);
+
   if (print_status())
     set_print_variables(true);
 
@@ -120,6 +128,8 @@ maxint_t S2_easy(maxint_t x, int threads)
   if (x > to_maxint(limit))
     throw primecount_error("S2_easy(x): x must be <= " + limit);
 
+  threads = fit_memory_threads(x, alpha, threads);
+
   if (print_status())
     set_print_variables(true);
 
@@ -144,6 +154,8 @@ maxint_t S2_hard(maxint_t x, int threads)
   if (x > to_maxint(limit))
     throw primecount_error("S2_hard(x): x must be <= " + limit);
 
+  threads = fit_memory_threads(x, alpha, threads);
+
   if (print_status())
     set_print_variables(true);
 
@@ -151,13 +163,63 @@ maxint_t S2_hard(maxint_t x, int threads)
   int64_t z = (int64_t) (x / y);
   int64_t c = PhiTiny::get_c(y);
 
-  // TODO: find better S2_hard approximation formula
-  maxint_t s2_hard_approx = Li(x);
-
   if (x <= numeric_limits<int64_t>::max())
-    return S2_hard((int64_t) x, y, z, c, (int64_t) s2_hard_approx, threads);
+    return S2_hard((int64_t) x, y, z, c, threads);
   else
-    return S2_hard(x, y, z, c, s2_hard_approx, threads);
+    return S2_hard(x, y, z, c, threads);
+}
+
+/// Build the cache files of the lookup tables used
+/// to compute pi(x) using the Deleglise-Rivat algorithm.
+/// @return  The total size of the cache files in bytes.
+///
+int64_t build_cache(maxint_t x, int threads)
+{
+  if (x < 1)
+    return 0;
+
+  double alpha = get_alpha_deleglise_rivat(x);
+  string limit = get_max_x(alpha);
+
+  if (x > to_maxint(limit))
+    throw primecount_error("build_cache(x): x must be <= " + limit);
+
+  threads = fit_memory_threads(x, alpha, threads);
+
+  int64_t y = (int64_t) (iroot<3>(x) * alpha);
+  int64_t z = (int64_t) (x / y);
+  int64_t c = PhiTiny::get_c(y);
+
+  return build_cache(y, z, c, threads);
+}
+
+/// @return  false if the algorithm does not fit its
+///          memory usage into --max-memory.
+///
+bool is_memory_budget(int option)
+{
+  switch (option)
+  {
+    case OPTION_DELEGLISE_RIVAT1:
+    case OPTION_DELEGLISE_RIVAT2:
+    case OPTION_DELEGLISE_RIVAT_PARALLEL1:
+    case OPTION_LEGENDRE:
+    case OPTION_LEHMER:
+    case OPTION_LMO:
+    case OPTION_LMO1:
+    case OPTION_LMO2:
+    case OPTION_LMO3:
+    case OPTION_LMO4:
+    case OPTION_LMO5:
+    case OPTION_LMO_PARALLEL1:
+    case OPTION_LMO_PARALLEL2:
+    case OPTION_LMO_PARALLEL3:
+    case OPTION_MEISSEL:
+    case OPTION_PRIMESIEVE:
+      return false;
+    default:
+      return true;
+  }
 }
 
 } // namespace
@@ -177,8 +239,17 @@ int main (int argc, char* argv[])
 
   try
   {
+    if (is_max_memory() && !is_memory_budget(pco.option))
+      throw primecount_error("--max-memory is only supported by the Deleglise-Rivat algorithm");
+
+    reset_event_counters();
+
     switch (pco.option)
     {
+      case OPTION_BENCHMARK:
+        benchmark(x, threads, pco.repeat, pco.json); break;
+      case OPTION_BUILD_CACHE:
+        res = build_cache(x, threads); break;
       case OPTION_DELEGLISE_RIVAT:
         res = pi_deleglise_rivat(x, threads); break;
       case OPTION_DELEGLISE_RIVAT1:
@@ -217,6 +288,8 @@ int main (int argc, char* argv[])
         res = pi_primesieve(int64_cast(x), threads); break;
       case OPTION_P2:
         res = P2(x, threads); break;
+      case OPTION_RANGE:
+        res = pi_range(pco.a, x, threads); break;
       case OPTION_PI:
         res = pi(x, threads); break;
       case OPTION_LI:
@@ -224,7 +297,7 @@ int main (int argc, char* argv[])
       case OPTION_LIINV:
         res = Li_inverse(int64_cast(x)); break;
       case OPTION_NTHPRIME:
-        res = nth_prime(int64_cast(x), threads); break;
+        res = nth_prime(x, threads); break;
       case OPTION_S1:
         res = S1(x, threads); break;
       case OPTION_S2_EASY:
@@ -233,6 +306,8 @@ int main (int argc, char* argv[])
         res = S2_hard(x, threads); break;
       case OPTION_S2_TRIVIAL:
         res = S2_trivial(x, threads); break;
+      case OPTION_TUNE:
+        tune(int64_cast(x), threads); break;
 
 #ifdef HAVE_INT128_T
       case OPTION_DELEGLISE_RIVAT_PARALLEL3:
@@ -258,13 +333,19 @@ int main (int argc, char* argv[])
     return 1;
   }
 
-  if (print_result())
+  if (print_result() &&
+      pco.option != OPTION_BENCHMARK &&
+      pco.option != OPTION_TUNE)
   {
     if (print_status())
       cout << endl;
     cout << res << endl;
     if (pco.time)
       print_seconds(get_wtime() - time);
+    if (pco.time && is_hugepages())
+      cout << "Page size: " << get_page_size() << endl;
+
+    print_event_counters();
   }
 
 #ifdef HAVE_MPI
@@ -0,0 +1,236 @@
+///
+/// @file   benchmark.cpp
+/// @brief  Reproducible benchmark of the Deleglise-Rivat algorithm
+///         (primecount --benchmark). Computes pi(x) for
+///         x = 10^12, 10^13, ..., N using 1, 2, 4, ..., threads
+///         threads and reports the seconds of each formula
+///         (P2, S1, S2_trivial, S2_easy, S2_hard), the speedup
+///         and the parallel efficiency as a table and as JSON.
+///         Of the repeated runs the fastest (by total seconds)
+///         is reported, all columns of a row (formulas, total
+///         and with --perf the hardware performance counters)
+///         are from that same run, hence the formula seconds
+///         add up to the total.
+///
+/// Copyright (C) 2016 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primecount-internal.hpp>
+#include <primecount.hpp>
+#include <EventCounters.hpp>
+#include <PerfCounters.hpp>
+#include <print.hpp>
+#include <pmath.hpp>
+#include <int128.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace primecount;
+
+namespace {
+
+const char* formulas[] = { "P2", "S1", "S2_trivial", "S2_easy", "S2_hard" };
+
+const int num_formulas = 5;
+
+struct Run
+{
+  int exponent;
+  int threads;
+  maxint_t pix;
+  double seconds[num_formulas];
+  double total;
+  double speedup;
+  double efficiency;
+  map<string, PerfValues> perf;
+};
+
+/// Compute pi(10^exponent) repeat times and keep
+/// the formula timings of the fastest run.
+///
+Run benchmark_run(int exponent, int threads, int repeat)
+{
+  maxint_t x = ipow((maxint_t) 10, exponent);
+  Run run;
+  run.exponent = exponent;
+  run.threads = threads;
+  run.total = -1;
+  fill_n(run.seconds, num_formulas, -1.0);
+
+  for (int i = 0; i < repeat; i++)
+  {
+    reset_timings();
+    reset_perf();
+    reset_event_counters();
+    double time = get_wtime();
+    maxint_t pix = pi_deleglise_rivat(x, threads);
+    double total = get_wtime() - time;
+    map<string, double> timings = get_timings();
+
+    if (i > 0 && pix != run.pix)
+      throw primecount_error("benchmark: pi(x) differs between runs");
+
+    run.pix = pix;
+    if (run.total < 0 || total < run.total)
+    {
+      run.total = total;
+      run.perf = get_perf_stages();
+      for (int j = 0; j < num_formulas; j++)
+        run.seconds[j] = timings[formulas[j]];
+    }
+  }
+
+  return run;
+}
+
+void print_header()
+{
+  cout << setw(6) << "x" << setw(8) << "threads";
+  for (int j = 0; j < num_formulas; j++)
+    cout << setw(12) << formulas[j];
+  cout << setw(12) << "total"
+       << setw(9) << "speedup"
+       << setw(11) << "efficiency" << endl;
+}
+
+void print_row(const Run& run)
+{
+  ostringstream x;
+  x << "1e" << run.exponent;
+
+  cout << setw(6) << x.str() << setw(8) << run.threads;
+  cout << fixed << setprecision(3);
+  for (int j = 0; j < num_formulas; j++)
+    cout << setw(12) << run.seconds[j];
+  cout << setw(12) << run.total
+       << setw(9) << run.speedup
+       << setw(11) << run.efficiency << endl;
+}
+
+/// Formulas without parallel sections
+/// (S2_trivial) have no counters.
+///
+void save_perf(ofstream& json, const map<string, PerfValues>& stages)
+{
+  json << ", \"perf\": { ";
+  bool first = true;
+
+  for (int j = 0; j < num_formulas; j++)
+  {
+    map<string, PerfValues>::const_iterator it = stages.find(formulas[j]);
+    if (it == stages.end())
+      continue;
+
+    const PerfValues& perf = it->second;
+    json << (first ? "" : ", ") << "\"" << formulas[j] << "\": { ";
+    first = false;
+
+    for (int i = 0; i < NUM_PERF_EVENTS; i++)
+    {
+      json << (i > 0 ? ", " : "") << "\"" << perf_event_name(i) << "\": ";
+      if (perf.values[i] < 0)
+        json << "null";
+      else
+        json << perf.values[i];
+    }
+
+    json << " }";
+  }
+
+  json << " }";
+}
+
+void save_json(const string& filename, const vector<Run>& runs, int repeat)
+{
+  ofstream json(filename.c_str());
+
+  if (!json)
+    throw primecount_error("failed to write " + filename);
+
+  json << fixed << setprecision(3);
+  json << "{" << endl;
+  json << "  \"version\": \"" << primecount_version() << "\"," << endl;
+  json << "  \"repeat\": " << repeat << "," << endl;
+  json << "  \"runs\": [" << endl;
+
+  for (size_t i = 0; i < runs.size(); i++)
+  {
+    const Run& run = runs[i];
+    json << "    { \"x\": \"1e" << run.exponent << "\""
+         << ", \"threads\": " << run.threads
+         << ", \"pi\": \"" << run.pix << "\""
+         << ", \"seconds\": { ";
+    for (int j = 0; j < num_formulas; j++)
+      json << "\"" << formulas[j] << "\": " << run.seconds[j] << ", ";
+    json << "\"total\": " << run.total << " }"
+         << ", \"speedup\": " << run.speedup
+         << ", \"efficiency\": " << run.efficiency;
+    if (is_perf())
+      save_perf(json, run.perf);
+    json << " }" << (i + 1 < runs.size() ? "," : "") << endl;
+  }
+
+  json << "  ]" << endl;
+  json << "}" << endl;
+
+  cout << endl << "Saved JSON results to " << filename << endl;
+}
+
+} // namespace
+
+namespace primecount {
+
+/// Benchmark pi(x) for x = 10^12, 10^13, ..., max_x
+/// using 1, 2, 4, ..., threads threads.
+///
+void benchmark(maxint_t max_x, int threads, int repeat, const string& json)
+{
+  if (max_x < ipow((maxint_t) 10, 12))
+    throw primecount_error("--benchmark limit must be >= 1e12");
+  if (max_x > to_maxint(get_max_x()))
+    throw primecount_error("--benchmark limit must be <= " + get_max_x());
+
+  vector<int> sweep;
+  for (int t = 1; t < threads; t *= 2)
+    sweep.push_back(t);
+  sweep.push_back(max(threads, 1));
+
+  repeat = max(repeat, 1);
+  set_print_status(false);
+  print_header();
+  vector<Run> runs;
+
+  for (int e = 12; ipow((maxint_t) 10, e) <= max_x; e++)
+  {
+    double seconds1 = 0;
+
+    for (size_t i = 0; i < sweep.size(); i++)
+    {
+      Run run = benchmark_run(e, sweep[i], repeat);
+
+      if (i == 0)
+        seconds1 = run.total;
+
+      run.speedup = seconds1 / max(run.total, 1e-9);
+      run.efficiency = run.speedup / run.threads;
+      runs.push_back(run);
+      print_row(run);
+    }
+  }
+
+  save_json(json, runs, repeat);
+}
+
+} // namespace
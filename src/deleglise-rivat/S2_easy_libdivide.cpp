@@ -14,11 +14,15 @@
 #include <PiTable.hpp>
 #include <primecount-internal.hpp>
 #include <generate.hpp>
+#include <HugePageAllocator.hpp>
 #include <int128.hpp>
 #include <min_max.hpp>
 #include <pmath.hpp>
+#include <EventCounters.hpp>
+#include <PerfCounters.hpp>
 #include <S2Status.hpp>
 #include <S2.hpp>
+#include <numa.hpp>
 
 #include <libdivide.h>
 #include <stdint.h>
@@ -48,6 +52,98 @@ libdivide_vector(Primes& primes)
   return vector<fastdiv_t>(primes.begin(), primes.end());
 }
 
+/// Calculate the contribution of the clustered easy leaves
+/// and the sparse easy leaves of the b-th prime.
+///
+template <typename T, typename Primes>
+T S2_easy_b(T x,
+            int64_t y,
+            int64_t z,
+            int64_t b,
+            const PiTable& pi,
+            const Primes& primes,
+            const vector<fastdiv_t>& fastdiv,
+            EventCounters& events)
+{
+  T s2_easy = 0;
+  int64_t prime = primes[b];
+  T x2 = x / prime;
+  int64_t min_trivial = min(x2 / prime, y);
+  int64_t min_clustered = (int64_t) isqrt(x2);
+  int64_t min_sparse = z / prime;
+  int64_t min_hard = max(y / prime, prime);
+
+  min_clustered = in_between(min_hard, min_clustered, y);
+  min_sparse = in_between(min_hard, min_sparse, y);
+
+  int64_t l = pi[min_trivial];
+  int64_t pi_min_clustered = pi[min_clustered];
+  int64_t pi_min_sparse = pi[min_sparse];
+
+  if (is_libdivide(x2))
+  {
+    // Find all clustered easy leaves:
+    // n = primes[b] * primes[l]
+    // x / n <= y && phi(x / n, b - 1) == phi(x / m, b - 1)
+    // where phi(x / n, b - 1) = pi(x / n) - b + 2
+    while (l > pi_min_clustered)
+    {
+      int64_t xn = (uint64_t) x2 / fastdiv[l];
+      int64_t phi_xn = pi[xn] - b + 2;
+      int64_t xm = (uint64_t) x2 / fastdiv[b + phi_xn - 1];
+      xm = max(xm, min_clustered);
+      int64_t l2 = pi[xm];
+      COUNT_EVENT(events, S2_EASY_CLUSTERED_LEAVES, l - l2);
+      COUNT_EVENT(events, S2_EASY_CLUSTERED_STEPS, 1);
+      s2_easy += phi_xn * (l - l2);
+      l = l2;
+    }
+
+    COUNT_EVENT(events, S2_EASY_SPARSE_LEAVES, max(l - pi_min_sparse, (int64_t) 0));
+
+    // Find all sparse easy leaves:
+    // n = primes[b] * primes[l]
+    // x / n <= y && phi(x / n, b - 1) = pi(x / n) - b + 2
+    for (; l > pi_min_sparse; l--)
+    {
+      int64_t xn = (uint64_t) x2 / fastdiv[l];
+      s2_easy += pi[xn] - b + 2;
+    }
+  }
+  else
+  {
+    // Find all clustered easy leaves:
+    // n = primes[b] * primes[l]
+    // x / n <= y && phi(x / n, b - 1) == phi(x / m, b - 1)
+    // where phi(x / n, b - 1) = pi(x / n) - b + 2
+    while (l > pi_min_clustered)
+    {
+      int64_t xn = (int64_t) (x2 / primes[l]);
+      int64_t phi_xn = pi[xn] - b + 2;
+      int64_t xm = (int64_t) (x2 / primes[b + phi_xn - 1]);
+      xm = max(xm, min_clustered);
+      int64_t l2 = pi[xm];
+      COUNT_EVENT(events, S2_EASY_CLUSTERED_LEAVES, l - l2);
+      COUNT_EVENT(events, S2_EASY_CLUSTERED_STEPS, 1);
+      s2_easy += phi_xn * (l - l2);
+      l = l2;
+    }
+
+    COUNT_EVENT(events, S2_EASY_SPARSE_LEAVES, max(l - pi_min_sparse, (int64_t) 0));
+
+    // Find all sparse easy leaves:
+    // n = primes[b] * primes[l]
+    // x / n <= y && phi(x / n, b - 1) = pi(x / n) - b + 2
+    for (; l > pi_min_sparse; l--)
+    {
+      int64_t xn = (int64_t) (x2 / primes[l]);
+      s2_easy += pi[xn] - b + 2;
+    }
+  }
+
+  return s2_easy;
+}
+
 /// Calculate the contribution of the clustered easy
 /// leaves and the sparse easy leaves.
 ///
@@ -64,83 +160,33 @@ T S2_easy_OpenMP(T x,
   threads = ideal_num_threads(threads, x13, 1000);
   vector<fastdiv_t> fastdiv = libdivide_vector(primes);
 
-  PiTable pi(y);
+  PiTable pi(y, threads);
   int64_t pi_sqrty = pi[isqrt(y)];
   int64_t pi_x13 = pi[x13];
   S2Status status(x);
 
-  #pragma omp parallel for schedule(dynamic) num_threads(threads) reduction(+: s2_easy)
-  for (int64_t b = max(c, pi_sqrty) + 1; b <= pi_x13; b++)
-  {
-    int64_t prime = primes[b];
-    T x2 = x / prime;
-    int64_t min_trivial = min(x2 / prime, y);
-    int64_t min_clustered = (int64_t) isqrt(x2);
-    int64_t min_sparse = z / prime;
-    int64_t min_hard = max(y / prime, prime);
-
-    min_clustered = in_between(min_hard, min_clustered, y);
-    min_sparse = in_between(min_hard, min_sparse, y);
+  // copy the lookup tables to each NUMA node
+  NumaReplicas<PiTable> numa_pi(pi);
+  NumaReplicas<Primes> numa_primes(primes);
+  NumaReplicas<vector<fastdiv_t> > numa_fastdiv(fastdiv);
 
-    int64_t l = pi[min_trivial];
-    int64_t pi_min_clustered = pi[min_clustered];
-    int64_t pi_min_sparse = pi[min_sparse];
+  #pragma omp parallel num_threads(threads) reduction(+: s2_easy)
+  {
+    NumaBinding binding;
+    int node = binding.node();
+    PerfCounters perf;
+    EventCounters events;
 
-    if (is_libdivide(x2))
-    {
-      // Find all clustered easy leaves:
-      // n = primes[b] * primes[l]
-      // x / n <= y && phi(x / n, b - 1) == phi(x / m, b - 1)
-      // where phi(x / n, b - 1) = pi(x / n) - b + 2
-      while (l > pi_min_clustered)
-      {
-        int64_t xn = (uint64_t) x2 / fastdiv[l];
-        int64_t phi_xn = pi[xn] - b + 2;
-        int64_t xm = (uint64_t) x2 / fastdiv[b + phi_xn - 1];
-        xm = max(xm, min_clustered);
-        int64_t l2 = pi[xm];
-        s2_easy += phi_xn * (l - l2);
-        l = l2;
-      }
-
-      // Find all sparse easy leaves:
-      // n = primes[b] * primes[l]
-      // x / n <= y && phi(x / n, b - 1) = pi(x / n) - b + 2
-      for (; l > pi_min_sparse; l--)
-      {
-        int64_t xn = (uint64_t) x2 / fastdiv[l];
-        s2_easy += pi[xn] - b + 2;
-      }
-    }
-    else
+    #pragma omp for schedule(dynamic)
+    for (int64_t b = max(c, pi_sqrty) + 1; b <= pi_x13; b++)
     {
-      // Find all clustered easy leaves:
-      // n = primes[b] * primes[l]
-      // x / n <= y && phi(x / n, b - 1) == phi(x / m, b - 1)
-      // where phi(x / n, b - 1) = pi(x / n) - b + 2
-      while (l > pi_min_clustered)
-      {
-        int64_t xn = (int64_t) (x2 / primes[l]);
-        int64_t phi_xn = pi[xn] - b + 2;
-        int64_t xm = (int64_t) (x2 / primes[b + phi_xn - 1]);
-        xm = max(xm, min_clustered);
-        int64_t l2 = pi[xm];
-        s2_easy += phi_xn * (l - l2);
-        l = l2;
-      }
-
-      // Find all sparse easy leaves:
-      // n = primes[b] * primes[l]
-      // x / n <= y && phi(x / n, b - 1) = pi(x / n) - b + 2
-      for (; l > pi_min_sparse; l--)
-      {
-        int64_t xn = (int64_t) (x2 / primes[l]);
-        s2_easy += pi[xn] - b + 2;
-      }
+      s2_easy += S2_easy_b(x, y, z, b, numa_pi[node], numa_primes[node], numa_fastdiv[node], events);
+
+      if (print_status())
+        status.print(b, pi_x13);
     }
 
-    if (print_status())
-      status.print(b, pi_x13);
+    events.merge();
   }
 
   return s2_easy;
@@ -167,7 +213,8 @@ int64_t S2_easy(int64_t x,
   print(x, y, c, threads);
 
   double time = get_wtime();
-  vector<int32_t> primes = generate_primes<int32_t>(y);
+  vector<int32_t, HugePageAllocator<int32_t> > primes;
+  generate_primes(y, primes);
   int64_t s2_easy = S2_easy_OpenMP((intfast64_t) x, y, z, c, primes, threads);
 
   print("S2_easy", s2_easy, time);
@@ -198,12 +245,14 @@ int128_t S2_easy(int128_t x,
   // uses less memory
   if (y <= numeric_limits<uint32_t>::max())
   {
-    vector<uint32_t> primes = generate_primes<uint32_t>(y);
+    vector<uint32_t, HugePageAllocator<uint32_t> > primes;
+    generate_primes(y, primes);
     s2_easy = S2_easy_OpenMP((intfast128_t) x, y, z, c, primes, threads);
   }
   else
   {
-    vector<int64_t> primes = generate_primes<int64_t>(y);
+    vector<int64_t, HugePageAllocator<int64_t> > primes;
+    generate_primes(y, primes);
     s2_easy = S2_easy_OpenMP((intfast128_t) x, y, z, c, primes, threads);
   }
 
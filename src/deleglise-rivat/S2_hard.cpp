@@ -16,20 +16,35 @@
 #include <FactorTable.hpp>
 #include <primecount-internal.hpp>
 #include <BitSieve.hpp>
+#include <BitSieve210.hpp>
+#include <BlockCounters.hpp>
+#include <EventCounters.hpp>
+#include <PerfCounters.hpp>
 #include <fast_div.hpp>
 #include <generate.hpp>
+#include <HugePageAllocator.hpp>
 #include <int128.hpp>
+#include <LeafDensity.hpp>
 #include <min_max.hpp>
+#include <numa.hpp>
 #include <pmath.hpp>
 #include <S2.hpp>
+#include <S2Checkpoint.hpp>
 #include <S2LoadBalancer.hpp>
 #include <S2Status.hpp>
-#include <tos_counters.hpp>
 #include <Wheel.hpp>
 
 #include <stdint.h>
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <string>
 #include <vector>
 
+#if defined(HAVE_LIBDIVIDE)
+  #include <libdivide.h>
+#endif
+
 #ifdef _OPENMP
   #include <omp.h>
 #endif
@@ -39,67 +54,186 @@ using namespace primecount;
 
 namespace {
 
-/// Cross-off the multiples of prime in the sieve array.
+/// Microseconds an idle thread sleeps before it
+/// tries again to claim an interval
+///
+const int64_t min_backoff = 50;
+const int64_t max_backoff = 20000;
+
+/// Divides by the primes <= y. If libdivide is enabled the
+/// divisions x2 / primes[l] of the hard special leaves are
+/// replaced by a multiplication and a shift using
+/// precomputed branchfree dividers. The dividers do not
+/// reference the primes, hence each NUMA replica divides
+/// by its node's local primes.
+///
+template <typename Primes>
+class PrimeDividers
+{
+public:
+  PrimeDividers(const Primes& primes, int64_t y)
+  {
+#if !defined(HAVE_LIBDIVIDE)
+    unused_param(primes);
+    unused_param(y);
+#endif
+#if defined(HAVE_LIBDIVIDE)
+    int64_t size = upper_bound(primes.begin(), primes.end(), y) - primes.begin();
+    fastdiv_.assign(primes.begin(), primes.begin() + size);
+#endif
+  }
+
+  /// @return x / primes[l]
+  /// @pre primes[l] <= y
+  ///
+  template <typename T>
+  int64_t divide(T x, int64_t l, const Primes& primes) const
+  {
+#if defined(HAVE_LIBDIVIDE)
+    if (x <= numeric_limits<uint64_t>::max())
+      return (uint64_t) x / fastdiv_[l];
+#endif
+    return (int64_t) fast_div(x, primes[l]);
+  }
+private:
+#if defined(HAVE_LIBDIVIDE)
+  typedef libdivide::divider<uint64_t, libdivide::BRANCHFREE> fastdiv_t;
+  vector<fastdiv_t> fastdiv_;
+#endif
+};
+
+/// Cross-off the multiples of the b-th prime in the sieve array.
+/// Primes larger than the segment often have no multiple
+/// in the current segment, these return immediately.
 /// @return  Count of crossed-off multiples.
 ///
-int64_t cross_off(BitSieve& sieve,
+template <typename Sieve>
+int64_t cross_off(Sieve& sieve,
                   int64_t low,
                   int64_t high,
                   int64_t prime,
-                  WheelItem& w)
+                  CompactWheel& wheel,
+                  int64_t b,
+                  EventCounters& events)
 {
+  int64_t m = wheel.next_multiple(b);
+
+  if (m >= high)
+    return 0;
+
   int64_t unset = 0;
-  int64_t m = w.next_multiple;
-  int64_t wheel_index = w.wheel_index;
+  int64_t wheel_index = wheel.wheel_index(b);
 
   for (; m < high; m += prime * Wheel::next_multiple_factor(&wheel_index))
   {
     // +1 if m is unset the first time
-    unset += sieve[m - low];
-    sieve.unset(m - low);
+    uint64_t i = sieve.get_index(m - low);
+    unset += sieve[i];
+    sieve.unset(i);
+    COUNT_EVENT(events, S2_HARD_CROSS_OFFS, 1);
   }
 
-  w.set(m, wheel_index);
+  wheel.set(b, m, wheel_index);
   return unset;
 }
 
-/// Cross-off the multiples of prime in the sieve array.
+/// Cross-off the multiples of the b-th prime in the sieve array.
 /// For each element that is unmarked the first time update
-/// the special counters tree data structure.
+/// the block counters.
 ///
-template <typename T>
-void cross_off(BitSieve& sieve,
+template <typename Sieve>
+void cross_off(Sieve& sieve,
                int64_t low,
                int64_t high,
                int64_t prime,
-               WheelItem& w,
-               T& counters)
+               CompactWheel& wheel,
+               int64_t b,
+               BlockCounters<Sieve>& counters,
+               EventCounters& events)
 {
-  int64_t segment_size = sieve.size();
-  int64_t m = w.next_multiple;
-  int64_t wheel_index = w.wheel_index;
+  int64_t m = wheel.next_multiple(b);
+
+  if (m >= high)
+    return;
+
+  int64_t wheel_index = wheel.wheel_index(b);
 
   for (; m < high; m += prime * Wheel::next_multiple_factor(&wheel_index))
   {
-    if (sieve[m - low])
+    COUNT_EVENT(events, S2_HARD_CROSS_OFFS, 1);
+
+    uint64_t i = sieve.get_index(m - low);
+
+    if (sieve[i])
     {
-      sieve.unset(m - low);
-      cnt_update(counters, m - low, segment_size);
+      sieve.unset(i);
+      counters.unset(i);
+      COUNT_EVENT(events, S2_HARD_CNT_UPDATE, 1);
     }
   }
 
-  w.set(m, wheel_index);
+  wheel.set(b, m, wheel_index);
 }
 
-/// @return  true if the interval [low, high] contains
-///          few hard special leaves.
+/// @return  true if the interval [low, high[ contains few
+///          hard special leaves, in which case counting using
+///          POPCNT is faster than using the block counters.
+/// @param prev_leaves  Number of special leaves of the previous
+///          segment or -1 for the first segment.
+///
+/// The leaf density changes slowly from one segment to the next,
+/// hence the previous segment is a good estimate of the current
+/// segment. The block counters are faster once there are more
+/// special leaves than numbers in the segment (measured).
+/// For the first segment of each interval we fall back to a
+/// static rule based on the location of the leaves.
 ///
 bool few_leaves(int64_t low,
                 int64_t high,
                 int64_t y,
-                double alpha)
+                double alpha,
+                int64_t prev_leaves)
+{
+  if (prev_leaves < 0)
+    return (high < y || low > y * alpha);
+
+  return prev_leaves < high - low;
+}
+
+/// Number of 64-bit words scanned by sieve.count(start,
+/// stop, low, high, ...) which counts either forwards
+/// or backwards depending on what's faster.
+///
+template <typename Sieve>
+int64_t sieve_words(const Sieve& sieve, int64_t start, int64_t stop, int64_t low, int64_t high)
 {
-  return (high < y || low > y * alpha);
+  if (start > stop)
+    return 0;
+
+  int64_t i = sieve.get_index(start);
+  int64_t j = sieve.get_index(stop);
+  int64_t k = sieve.get_index((high - 1) - low);
+
+  return min(j - i, k - j) / 64 + 1;
+}
+
+/// Number of segments processed using each counting method
+struct SegmentModes
+{
+  int64_t popcount;
+  int64_t counters;
+};
+
+void print_modes(const SegmentModes& modes)
+{
+  if (print_status())
+  {
+    ostringstream oss;
+    oss << "\r" << string(50, ' ') << "\r";
+    oss << "Segments: " << modes.popcount << " popcount, ";
+    oss << modes.counters << " block counters";
+    print(oss.str());
+  }
 }
 
 /// Compute the S2 contribution of the hard special leaves which
@@ -108,8 +242,10 @@ bool few_leaves(int64_t low,
 /// and the missing special leaf contributions for the interval
 /// [1, low_process[ are later reconstructed and added in
 /// the parent S2_hard_OpenMP_master() function.
+/// @tparam Sieve  BitSieve210 if c >= 4, it only stores
+///                the numbers coprime to 210.
 ///
-template <typename T, typename FactorTable, typename Primes>
+template <typename Sieve, typename T, typename FactorTable, typename Primes>
 T S2_hard_OpenMP_thread(T x,
                         int64_t y,
                         int64_t z,
@@ -120,11 +256,14 @@ T S2_hard_OpenMP_thread(T x,
                         int64_t low,
                         int64_t limit,
                         double alpha,
-                        FactorTable& factors,
-                        PiTable& pi,
-                        Primes& primes,
+                        const FactorTable& factors,
+                        const PiTable& pi,
+                        const Primes& primes,
+                        const PrimeDividers<Primes>& dividers,
                         vector<int64_t>& mu_sum,
-                        vector<int64_t>& phi)
+                        vector<int64_t>& phi,
+                        SegmentModes& modes,
+                        EventCounters& events)
 {
   low += segment_size * segments_per_thread * thread_num;
   limit = min(low + segment_size * segments_per_thread, limit);
@@ -135,12 +274,14 @@ T S2_hard_OpenMP_thread(T x,
   if (c > max_b)
     return s2_hard;
 
-  BitSieve sieve(segment_size);
-  Wheel wheel(primes, max_b + 1, low);
-  vector<int32_t> counters;
+  Sieve sieve(segment_size);
+  CompactWheel wheel(primes, max_b + 1, low);
+  BlockCounters<Sieve> counters(sieve);
   phi.resize(max_b + 1, 0);
   mu_sum.resize(max_b + 1, 0);
 
+  int64_t prev_leaves = -1;
+
   // Segmented sieve of Eratosthenes
   for (; low < limit; low += segment_size)
   {
@@ -154,7 +295,12 @@ T S2_hard_OpenMP_thread(T x,
     // If there are relatively few hard special leaves per segment
     // we count the number of unsieved elements directly from the
     // sieve array using the POPCNT instruction.
-    if (few_leaves(low, high, y, alpha))
+    bool is_popcount = few_leaves(low, high, y, alpha, prev_leaves);
+    modes.popcount += is_popcount;
+    modes.counters += !is_popcount;
+    int64_t leaves = 0;
+
+    if (is_popcount)
     {
       int64_t count_low_high = sieve.count((high - 1) - low);
 
@@ -176,6 +322,7 @@ T S2_hard_OpenMP_thread(T x,
 
         factors.to_index(&min_m);
         factors.to_index(&max_m);
+        COUNT_EVENT(events, S2_HARD_FACTOR_LOOKUPS, max_m - min_m);
 
         for (int64_t m = max_m; m > min_m; m--)
         {
@@ -184,17 +331,20 @@ T S2_hard_OpenMP_thread(T x,
             int64_t fm = factors.get_number(m);
             int64_t xn = (int64_t) fast_div(x2, fm);
             int64_t stop = xn - low;
+            COUNT_EVENT(events, S2_HARD_SIEVE_WORDS, sieve_words(sieve, start, stop, low, high));
             count += sieve.count(start, stop, low, high, count, count_low_high);
             start = stop + 1;
             int64_t phi_xn = phi[b] + count;
             int64_t mu_m = factors.mu(m);
             s2_hard -= mu_m * phi_xn;
             mu_sum[b] -= mu_m;
+            leaves++;
+            COUNT_EVENT(events, S2_HARD_LEAVES_SQRTY, 1);
           }
         }
 
         phi[b] += count_low_high;
-        count_low_high -= cross_off(sieve, low, high, prime, wheel[b]);
+        count_low_high -= cross_off(sieve, low, high, prime, wheel, b, events);
       }
 
       // For pi_sqrty <= b <= pi_sqrtz
@@ -216,31 +366,31 @@ T S2_hard_OpenMP_thread(T x,
 
         for (; primes[l] > min_hard; l--)
         {
-          int64_t xn = (int64_t) fast_div(x2, primes[l]);
+          int64_t xn = dividers.divide(x2, l, primes);
           int64_t stop = xn - low;
+          COUNT_EVENT(events, S2_HARD_SIEVE_WORDS, sieve_words(sieve, start, stop, low, high));
           count += sieve.count(start, stop, low, high, count, count_low_high);
           start = stop + 1;
           int64_t phi_xn = phi[b] + count;
           s2_hard += phi_xn;
           mu_sum[b]++;
+          leaves++;
+          COUNT_EVENT(events, S2_HARD_LEAVES_SQRTZ, 1);
         }
 
         phi[b] += count_low_high;
-        count_low_high -= cross_off(sieve, low, high, prime, wheel[b]);
+        count_low_high -= cross_off(sieve, low, high, prime, wheel, b, events);
       }
     }
     else
     {
       // Calculate the contribution of the hard special leaves using
-      // Tomás Oliveira's O(log(N)) special tree data structure
-      // for counting the number of unsieved elements. This algorithm
-      // runs fastest if there are many special leaves per segment.
+      // block counters for counting the number of unsieved elements.
+      // This algorithm runs fastest if there are many special
+      // leaves per segment.
 
-      // allocate memory upon first usage
-      counters.resize(segment_size);
-
-      // Initialize special tree data structure from sieve
-      cnt_finit(sieve, counters, segment_size);
+      // Initialize the block counters from sieve
+      counters.init(sieve.get_index((high - 1) - low) + 1);
 
       // For c + 1 <= b <= pi_sqrty
       // Find all special leaves: n = primes[b] * m
@@ -258,6 +408,7 @@ T S2_hard_OpenMP_thread(T x,
 
         factors.to_index(&min_m);
         factors.to_index(&max_m);
+        COUNT_EVENT(events, S2_HARD_FACTOR_LOOKUPS, max_m - min_m);
 
         for (int64_t m = max_m; m > min_m; m--)
         {
@@ -265,16 +416,20 @@ T S2_hard_OpenMP_thread(T x,
           {
             int64_t fm = factors.get_number(m);
             int64_t xn = (int64_t) fast_div(x2, fm);
-            int64_t count = cnt_query(counters, xn - low);
+            int64_t count = counters.count(sieve.get_index(xn - low));
             int64_t phi_xn = phi[b] + count;
             int64_t mu_m = factors.mu(m);
             s2_hard -= mu_m * phi_xn;
             mu_sum[b] -= mu_m;
+            leaves++;
+            COUNT_EVENT(events, S2_HARD_LEAVES_SQRTY, 1);
+            COUNT_EVENT(events, S2_HARD_CNT_QUERY, 1);
           }
         }
 
-        phi[b] += cnt_query(counters, (high - 1) - low);
-        cross_off(sieve, low, high, prime, wheel[b], counters);
+        phi[b] += counters.count();
+        cross_off(sieve, low, high, prime, wheel, b, counters, events);
+        counters.reset();
       }
 
       // For pi_sqrty <= b <= pi_sqrtz
@@ -294,24 +449,45 @@ T S2_hard_OpenMP_thread(T x,
 
         for (; primes[l] > min_hard; l--)
         {
-          int64_t xn = (int64_t) fast_div(x2, primes[l]);
-          int64_t count = cnt_query(counters, xn - low);
+          int64_t xn = dividers.divide(x2, l, primes);
+          int64_t count = counters.count(sieve.get_index(xn - low));
           int64_t phi_xn = phi[b] + count;
           s2_hard += phi_xn;
           mu_sum[b]++;
+          leaves++;
+          COUNT_EVENT(events, S2_HARD_LEAVES_SQRTZ, 1);
+          COUNT_EVENT(events, S2_HARD_CNT_QUERY, 1);
         }
 
-        phi[b] += cnt_query(counters, (high - 1) - low);
-        cross_off(sieve, low, high, prime, wheel[b], counters);
+        phi[b] += counters.count();
+        cross_off(sieve, low, high, prime, wheel, b, counters, events);
+        counters.reset();
       }
     }
 
-    next_segment:;
+    next_segment:
+    prev_leaves = leaves;
   }
 
   return s2_hard;
 }
 
+/// The result of the interval [low, high[ computed by
+/// S2_hard_OpenMP_thread(). The missing special leaf
+/// contributions of the interval can only be reconstructed
+/// once all previous intervals have been merged.
+///
+template <typename T>
+struct Interval
+{
+  int64_t low;
+  int64_t high;
+  T s2_hard;
+  double seconds;
+  vector<int64_t> phi;
+  vector<int64_t> mu_sum;
+};
+
 /// Calculate the contribution of the hard special leaves which
 /// require use of a sieve (to reduce the memory usage).
 /// This is a parallel implementation with advanced load balancing.
@@ -320,12 +496,24 @@ T S2_hard_OpenMP_thread(T x,
 /// per thread, after each iteration we dynamically increase
 /// the segment size and the segments per thread.
 ///
+/// There are no synchronized rounds: each thread claims the next
+/// interval from a shared work queue as soon as it has finished
+/// its previous interval. Finished intervals are merged in order
+/// (reconstruct the missing special leaf contributions) by
+/// whichever thread finds the next interval in order finished,
+/// while the other threads keep sieving. After each merge the
+/// state is periodically saved to the checkpoint file (if any)
+/// from which it can later be resumed.
+///
+/// @param limit  Only the special leaves with x / n < limit
+///               are computed, z + 1 for the whole S2_hard.
+///
 template <typename T, typename FactorTable, typename Primes>
 T S2_hard_OpenMP_master(T x,
                         int64_t y,
                         int64_t z,
                         int64_t c,
-                        T s2_hard_approx,
+                        int64_t limit,
                         Primes& primes,
                         FactorTable& factors,
                         int threads)
@@ -334,76 +522,296 @@ T S2_hard_OpenMP_master(T x,
 
   T s2_hard = 0;
   int64_t low = 1;
-  int64_t limit = z + 1;
   int64_t max_prime = z / isqrt(y);
 
   S2Status status(x);
+  LeafDensity density(x, y, z, c);
   S2LoadBalancer loadBalancer(x, y, z, threads);
   int64_t min_segment_size = loadBalancer.get_min_segment_size();
   int64_t segment_size = min_segment_size;
   int64_t segments_per_thread = 1;
 
-  PiTable pi(max_prime);
+  PiTable pi(max_prime, threads);
+  PrimeDividers<Primes> dividers(primes, y);
   vector<int64_t> phi_total(pi[isqrt(z)] + 1, 0);
   double alpha = get_alpha(x, y);
 
-  while (low < limit)
+  S2Checkpoint checkpoint(x, y, z, c);
+  maxint_t s2_checkpoint = 0;
+
+  if (checkpoint.load(&low, &segment_size, &segments_per_thread,
+                      &s2_checkpoint, phi_total, loadBalancer))
+    s2_hard = (T) s2_checkpoint;
+
+  density.skip(1, low);
+
+  if (low < limit)
+    threads = in_between(1, threads, ceil_div(limit - low, segment_size));
+
+  // The variables below are shared by all threads and must
+  // only be accessed inside the S2_hard critical section
+  int64_t next_low = low;
+  int64_t finished = 0;
+  int64_t unmerged = 0;
+  int64_t max_unmerged = threads * 4;
+  bool is_merging = false;
+  string checkpoint_error;
+  map<int64_t, Interval<T> > results;
+  SegmentModes modes = { 0, 0 };
+  aligned_vector<double> timings(threads);
+
+  // The variables below are only accessed by the thread
+  // which is currently merging the finished intervals
+  int64_t merged_low = low;
+  S2LoadBalancer mergedLoadBalancer = loadBalancer;
+  int64_t merged_segment_size = segment_size;
+  int64_t merged_segments_per_thread = segments_per_thread;
+
+  // copy the lookup tables to each NUMA node
+  NumaReplicas<FactorTable> numa_factors(factors);
+  NumaReplicas<PiTable> numa_pi(pi);
+  NumaReplicas<Primes> numa_primes(primes);
+  NumaReplicas<PrimeDividers<Primes> > numa_dividers(dividers);
+
+  #pragma omp parallel num_threads(threads)
   {
-    int64_t segments = ceil_div(limit - low, segment_size);
-    threads = in_between(1, threads, segments);
-    segments_per_thread = in_between(1, segments_per_thread, ceil_div(segments, threads));
+    Interval<T> interval;
+    bool done = false;
+    int64_t backoff = min_backoff;
+    NumaBinding binding;
+    int node = binding.node();
+    PerfCounters perf;
+
+    while (!done)
+    {
+      bool is_claimed = false;
+      int64_t thread_segment_size = 0;
+      int64_t thread_segments = 0;
+
+      // claim the next interval, but don't let the threads
+      // run too far ahead of the merged intervals as each
+      // unmerged interval holds its own phi vector
+      #pragma omp critical (S2_hard)
+      {
+        if (next_low >= limit || !checkpoint_error.empty())
+          done = true;
+        else if (unmerged < max_unmerged)
+        {
+          int64_t segments = ceil_div(limit - next_low, segment_size);
+          thread_segment_size = segment_size;
+          thread_segments = in_between(1, segments_per_thread, ceil_div(segments, threads));
+          interval.low = next_low;
+          interval.high = min(next_low + thread_segment_size * thread_segments, limit);
+          next_low = interval.high;
+          unmerged++;
+          is_claimed = true;
+        }
+      }
 
-    aligned_vector<vector<int64_t> > phi(threads);
-    aligned_vector<vector<int64_t> > mu_sum(threads);
-    aligned_vector<double> timings(threads);
+      // All threads are waiting for the first unmerged
+      // interval, sleep instead of spinning on the
+      // S2_hard critical section.
+      if (!is_claimed)
+      {
+        if (!done)
+        {
+          sleep_us(backoff);
+          backoff = min(backoff * 2, max_backoff);
+        }
+        continue;
+      }
 
-    #pragma omp parallel for num_threads(threads) reduction(+: s2_hard)
-    for (int i = 0; i < threads; i++)
-    {
-      timings[i] = get_wtime();
-      s2_hard += S2_hard_OpenMP_thread(x, y, z, c, segment_size, segments_per_thread,
-          i, low, limit, alpha, factors, pi, primes, mu_sum[i], phi[i]);
-      timings[i] = get_wtime() - timings[i];
-    }
+      backoff = min_backoff;
 
-    // Once all threads have finished reconstruct and add the 
-    // missing contribution of all special leaves. This must
-    // be done in order as each thread (i) requires the sum of
-    // the phi values from the previous threads.
-    //
-    for (int i = 0; i < threads; i++)
-    {
-      for (size_t j = 1; j < phi[i].size(); j++)
+      double seconds = get_wtime();
+      interval.phi.clear();
+      interval.mu_sum.clear();
+      SegmentModes thread_modes = { 0, 0 };
+      EventCounters events;
+
+      // BitSieve210 does not store the multiples of 2, 3, 5
+      // and 7, hence these must be pre-sieved (c >= 4)
+      if (c >= (int64_t) BitSieve210::min_c)
+        interval.s2_hard = S2_hard_OpenMP_thread<BitSieve210>(x, y, z, c, thread_segment_size, thread_segments, 0,
+            interval.low, limit, alpha, numa_factors[node], numa_pi[node], numa_primes[node],
+            numa_dividers[node], interval.mu_sum, interval.phi, thread_modes, events);
+      else
+        interval.s2_hard = S2_hard_OpenMP_thread<BitSieve>(x, y, z, c, thread_segment_size, thread_segments, 0,
+            interval.low, limit, alpha, numa_factors[node], numa_pi[node], numa_primes[node],
+            numa_dividers[node], interval.mu_sum, interval.phi, thread_modes, events);
+
+      seconds = get_wtime() - seconds;
+      events.merge();
+
+      bool is_merger = false;
+
+      #pragma omp critical (S2_hard)
       {
-        s2_hard += phi_total[j] * (T) mu_sum[i][j];
-        phi_total[j] += phi[i][j];
+        Interval<T>& result = results[interval.low];
+        result.low = interval.low;
+        result.high = interval.high;
+        result.s2_hard = interval.s2_hard;
+        result.seconds = seconds;
+        result.phi.swap(interval.phi);
+        result.mu_sum.swap(interval.mu_sum);
+
+        // the load balancer is updated whenever as many
+        // intervals as there are threads have finished
+        timings[finished++ % threads] = seconds;
+        modes.popcount += thread_modes.popcount;
+        modes.counters += thread_modes.counters;
+        if (finished % threads == 0)
+          loadBalancer.update(next_low, threads, &segment_size, &segments_per_thread, timings);
+
+        is_merger = !is_merging;
+        is_merging = true;
       }
-    }
 
-    low += segments_per_thread * threads * segment_size;
-    loadBalancer.update(low, threads, &segment_size, &segments_per_thread, timings);
+      // Reconstruct and add the missing contribution of all
+      // special leaves. This must be done in order as each
+      // interval requires the sum of the phi values from the
+      // previous intervals.
+      while (is_merger)
+      {
+        Interval<T> result;
+
+        #pragma omp critical (S2_hard)
+        {
+          typename map<int64_t, Interval<T> >::iterator it = results.find(merged_low);
+
+          if (it == results.end())
+            is_merging = is_merger = false;
+          else
+          {
+            result.high = it->second.high;
+            result.s2_hard = it->second.s2_hard;
+            result.seconds = it->second.seconds;
+            result.phi.swap(it->second.phi);
+            result.mu_sum.swap(it->second.mu_sum);
+            results.erase(it);
+            unmerged--;
+
+            mergedLoadBalancer = loadBalancer;
+            merged_segment_size = segment_size;
+            merged_segments_per_thread = segments_per_thread;
+          }
+        }
+
+        if (!is_merger)
+          break;
+
+        s2_hard += result.s2_hard;
+
+        for (size_t j = 1; j < result.phi.size(); j++)
+        {
+          s2_hard += phi_total[j] * (T) result.mu_sum[j];
+          phi_total[j] += result.phi[j];
+        }
+
+        density.add(merged_low, result.high, result.seconds);
+        merged_low = result.high;
+
+        // an exception must not escape the OpenMP parallel
+        // region, it is rethrown after the parallel region
+        try
+        {
+          checkpoint.save(merged_low, merged_segment_size, merged_segments_per_thread,
+              (maxint_t) s2_hard, phi_total, mergedLoadBalancer);
+        }
+        catch (exception& e)
+        {
+          #pragma omp critical (S2_hard)
+          {
+            if (checkpoint_error.empty())
+              checkpoint_error = e.what();
+          }
+
+          checkpoint.disable();
+        }
 
-    if (print_status())
-      status.print(s2_hard, s2_hard_approx, loadBalancer.get_rsd());
+        if (print_status())
+          status.print(density, threads, mergedLoadBalancer.get_rsd());
+      }
+    }
   }
 
+  if (!checkpoint_error.empty())
+    throw primecount_error(checkpoint_error);
+
+  bool force = true;
+  checkpoint.save(merged_low, merged_segment_size, merged_segments_per_thread,
+      (maxint_t) s2_hard, phi_total, mergedLoadBalancer, force);
+  print_modes(modes);
+
   return s2_hard;
 }
 
+/// @return  The seconds of S2_hard(x, y) extrapolated from
+///          the seconds of the interval [1, limit[ which
+///          contains percent of the work.
+///
+template <typename FactorTable, typename Primes>
+double S2_hard_sample(int64_t x,
+                      int64_t y,
+                      int64_t z,
+                      int64_t c,
+                      double percent,
+                      Primes& primes,
+                      int threads)
+{
+  double time = get_wtime();
+  FactorTable factors(y, threads);
+  LeafDensity density(x, y, z, c);
+  int64_t limit = density.find_limit(percent);
+  density.skip(1, limit);
+  double init = get_wtime() - time;
+
+  time = get_wtime();
+  S2_hard_OpenMP_master((intfast64_t) x, y, z, c, limit, primes, factors, threads);
+  double seconds = get_wtime() - time;
+
+  return init + seconds * 100 / max(density.percent(), 1.0);
+}
+
 } // namespace
 
 namespace primecount {
 
+/// Time S2_hard(x, y) over the interval [1, limit[ which
+/// contains percent of its work (see LeafDensity) and
+/// extrapolate the seconds of the whole S2_hard(x, y).
+/// Used by primecount --tune.
+///
+double S2_hard_sample_seconds(int64_t x,
+                              int64_t y,
+                              int64_t z,
+                              int64_t c,
+                              double percent,
+                              int threads)
+{
+  double time = get_wtime();
+  int64_t max_prime = z / isqrt(y);
+  vector<int32_t, HugePageAllocator<int32_t> > primes;
+  generate_primes(max_prime, primes);
+  double seconds = get_wtime() - time;
+
+  if (use_wheel2310(c))
+    seconds += S2_hard_sample<FactorTable<uint16_t, 2310> >(x, y, z, c, percent, primes, threads);
+  else
+    seconds += S2_hard_sample<FactorTable<uint16_t> >(x, y, z, c, percent, primes, threads);
+
+  return seconds;
+}
+
 int64_t S2_hard(int64_t x,
                 int64_t y,
                 int64_t z,
                 int64_t c,
-                int64_t s2_hard_approx,
                 int threads)
 {
 #ifdef HAVE_MPI
   if (mpi_num_procs() > 1)
-    return S2_hard_mpi(x, y, z, c, s2_hard_approx, threads);
+    return S2_hard_mpi(x, y, z, c, threads);
 #endif
 
   print("");
@@ -412,11 +820,22 @@ int64_t S2_hard(int64_t x,
   print(x, y, c, threads);
 
   double time = get_wtime();
-  FactorTable<uint16_t> factors(y, threads);
+  int64_t s2_hard;
   int64_t max_prime = z / isqrt(y);
-  vector<int32_t> primes = generate_primes(max_prime);
+  vector<int32_t, HugePageAllocator<int32_t> > primes;
+  generate_primes(max_prime, primes);
 
-  int64_t s2_hard = S2_hard_OpenMP_master((intfast64_t) x, y, z, c, (intfast64_t) s2_hard_approx, primes, factors, threads);
+  // uses less memory
+  if (use_wheel2310(c))
+  {
+    FactorTable<uint16_t, 2310> factors(y, threads);
+    s2_hard = S2_hard_OpenMP_master((intfast64_t) x, y, z, c, z + 1, primes, factors, threads);
+  }
+  else
+  {
+    FactorTable<uint16_t> factors(y, threads);
+    s2_hard = S2_hard_OpenMP_master((intfast64_t) x, y, z, c, z + 1, primes, factors, threads);
+  }
 
   print("S2_hard", s2_hard, time);
   return s2_hard;
@@ -428,12 +847,11 @@ int128_t S2_hard(int128_t x,
                  int64_t y,
                  int64_t z,
                  int64_t c,
-                 int128_t s2_hard_approx,
                  int threads)
 {
 #ifdef HAVE_MPI
   if (mpi_num_procs() > 1)
-    return S2_hard_mpi(x, y, z, c, s2_hard_approx, threads);
+    return S2_hard_mpi(x, y, z, c, threads);
 #endif
 
   print("");
@@ -447,19 +865,37 @@ int128_t S2_hard(int128_t x,
   // uses less memory
   if (y <= FactorTable<uint16_t>::max())
   {
-    FactorTable<uint16_t> factors(y, threads);
     int64_t max_prime = z / isqrt(y);
-    vector<uint32_t> primes = generate_primes<uint32_t>(max_prime);
+    vector<uint32_t, HugePageAllocator<uint32_t> > primes;
+    generate_primes(max_prime, primes);
 
-    s2_hard = S2_hard_OpenMP_master((intfast128_t) x, y, z, c, (intfast128_t) s2_hard_approx, primes, factors, threads);
+    if (use_wheel2310(c))
+    {
+      FactorTable<uint16_t, 2310> factors(y, threads);
+      s2_hard = S2_hard_OpenMP_master((intfast128_t) x, y, z, c, z + 1, primes, factors, threads);
+    }
+    else
+    {
+      FactorTable<uint16_t> factors(y, threads);
+      s2_hard = S2_hard_OpenMP_master((intfast128_t) x, y, z, c, z + 1, primes, factors, threads);
+    }
   }
   else
   {
-    FactorTable<uint32_t> factors(y, threads);
     int64_t max_prime = z / isqrt(y);
-    vector<int64_t> primes = generate_primes<int64_t>(max_prime);
+    vector<int64_t, HugePageAllocator<int64_t> > primes;
+    generate_primes(max_prime, primes);
 
-    s2_hard = S2_hard_OpenMP_master((intfast128_t) x, y, z, c, (intfast128_t) s2_hard_approx, primes, factors, threads);
+    if (use_wheel2310(c))
+    {
+      FactorTable<uint32_t, 2310> factors(y, threads);
+      s2_hard = S2_hard_OpenMP_master((intfast128_t) x, y, z, c, z + 1, primes, factors, threads);
+    }
+    else
+    {
+      FactorTable<uint32_t> factors(y, threads);
+      s2_hard = S2_hard_OpenMP_master((intfast128_t) x, y, z, c, z + 1, primes, factors, threads);
+    }
   }
 
   print("S2_hard", s2_hard, time);
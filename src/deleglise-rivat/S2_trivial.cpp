@@ -18,6 +18,7 @@
 
 #include <stdint.h>
 #include <algorithm>
+#include <cassert>
 #include <vector>
 
 #ifdef _OPENMP
@@ -29,6 +30,27 @@ using namespace primecount;
 
 namespace {
 
+/// Calculate x / (prime * prime) without integer division.
+/// The quotient is first estimated using floating point
+/// arithmetic, its error is at most 1 as x / (prime * prime)
+/// <= y < 2^50. Starting from estimate - 1 (which is never
+/// too large) the exact quotient is then computed by 2
+/// branchfree corrections.
+///
+template <typename T>
+int64_t div_prime_square(T x, double xd, int64_t prime)
+{
+  double pd = (double) prime;
+  T square = (T) prime * prime;
+  int64_t q = (int64_t) (xd / (pd * pd)) - 1;
+  q = max(q, (int64_t) 0);
+  T r = x - (T) q * square;
+  q += (r >= square);
+  q += (r >= square * 2);
+  assert(q == (int64_t) (x / square));
+  return q;
+}
+
 template <typename T>
 T S2_trivial_OpenMP(T x,
                     int64_t y,
@@ -39,7 +61,7 @@ T S2_trivial_OpenMP(T x,
   int64_t thread_threshold = ipow(10, 7);
   threads = ideal_num_threads(threads, y, thread_threshold);
 
-  PiTable pi(y);
+  PiTable pi(y, threads);
   int64_t pi_y = pi[y];
   int64_t sqrtz = isqrt(z);
   int64_t prime_c = nth_prime(c);
@@ -56,11 +78,12 @@ T S2_trivial_OpenMP(T x,
     start += thread_distance * i;
     int64_t stop = min(start + thread_distance, y);
     primesieve::iterator it(start - 1, stop);
-    T prime;
+    double xd = (double) x;
+    int64_t prime;
 
     while ((prime = it.next_prime()) < stop)
     {
-      int64_t xn = (int64_t) max(x / (prime * prime), prime);
+      int64_t xn = max(div_prime_square(x, xd, prime), prime);
       s2_trivial += pi_y - pi[xn];
     }
   }
@@ -76,7 +76,7 @@ int64_t S2_hard(int64_t x,
   print("=== S2_hard(x, y) ===");
   print("Computation of the hard special leaves");
 
-  PiTable pi(y);
+  PiTable pi(y, 1);
   FactorTable<uint16_t> factors(y, 1);
   vector<int32_t> primes = generate_primes(y);
 
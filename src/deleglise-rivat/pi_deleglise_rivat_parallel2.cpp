@@ -32,13 +32,11 @@ int64_t S2(int64_t x,
            int64_t y,
            int64_t z,
            int64_t c,
-           int64_t s2_approx,
            int threads)
 {
   int64_t s2_trivial = S2_trivial(x, y, z, c, threads);
   int64_t s2_easy = S2_easy(x, y, z, c, threads);
-  int64_t s2_hard_approx = s2_approx - (s2_trivial + s2_easy);
-  int64_t s2_hard = S2_hard(x, y, z, c, s2_hard_approx, threads);
+  int64_t s2_hard = S2_hard(x, y, z, c, threads);
   int64_t s2 = s2_trivial + s2_easy + s2_hard;
 
   return s2;
@@ -58,6 +56,7 @@ int64_t pi_deleglise_rivat_parallel2(int64_t x, int threads)
     return 0;
 
   double alpha = get_alpha_deleglise_rivat(x);
+  threads = fit_memory_threads(x, alpha, threads);
   int64_t x13 = iroot<3>(x);
   int64_t y = (int64_t) (x13 * alpha);
   int64_t z = x / y;
@@ -71,8 +70,7 @@ int64_t pi_deleglise_rivat_parallel2(int64_t x, int threads)
 
   int64_t p2 = P2(x, y, threads);
   int64_t s1 = S1(x, y, c, threads);
-  int64_t s2_approx = S2_approx(x, pi_y, p2, s1);
-  int64_t s2 = S2(x, y, z, c, s2_approx, threads);
+  int64_t s2 = S2(x, y, z, c, threads);
   int64_t phi = s1 + s2;
   int64_t sum = phi + pi_y - 1 - p2;
 
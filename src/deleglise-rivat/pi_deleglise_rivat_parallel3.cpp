@@ -33,13 +33,11 @@ int128_t S2(int128_t x,
             int64_t y,
             int64_t z,
             int64_t c,
-            int128_t s2_approx,
             int threads)
 {
   int128_t s2_trivial = S2_trivial(x, y, z, c, threads);
   int128_t s2_easy = S2_easy(x, y, z, c, threads);
-  int128_t s2_hard_approx = s2_approx - (s2_trivial + s2_easy);
-  int128_t s2_hard = S2_hard(x, y, z, c, s2_hard_approx, threads);
+  int128_t s2_hard = S2_hard(x, y, z, c, threads);
   int128_t s2 = s2_trivial + s2_easy + s2_hard;
 
   return s2;
@@ -59,6 +57,7 @@ int128_t pi_deleglise_rivat_parallel3(int128_t x, int threads)
     return 0;
 
   double alpha = get_alpha_deleglise_rivat(x);
+  threads = fit_memory_threads(x, alpha, threads);
   string limit = get_max_x(alpha);
 
   if (x > to_maxint(limit))
@@ -76,8 +75,7 @@ int128_t pi_deleglise_rivat_parallel3(int128_t x, int threads)
 
   int128_t p2 = P2(x, y, threads);
   int128_t s1 = S1(x, y, c, threads);
-  int128_t s2_approx = S2_approx(x, pi_y, p2, s1);
-  int128_t s2 = S2(x, y, z, c, s2_approx, threads);
+  int128_t s2 = S2(x, y, z, c, threads);
   int128_t phi = s1 + s2;
   int128_t sum = phi + pi_y - 1 - p2;
 
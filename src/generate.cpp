@@ -7,6 +7,7 @@
 /// file in the top level directory.
 ///
 
+#include <generate.hpp>
 #include <pmath.hpp>
 #include <primesieve.hpp>
 
@@ -24,10 +25,7 @@ namespace primecount {
 ///
 vector<int32_t> generate_primes(int64_t max)
 {
-  vector<int32_t> primes;
-  primes.push_back(0);
-  primesieve::generate_primes(max, &primes);
-  return primes;
+  return generate_primes<int32_t>(max);
 }
 
 /// Generate a vector with the first n primes.
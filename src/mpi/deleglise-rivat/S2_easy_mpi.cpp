@@ -49,7 +49,7 @@ T S2_easy_mpi_master(T x,
   int64_t thread_threshold = 1000;
   threads = ideal_num_threads(threads, x13, thread_threshold);
 
-  PiTable pi(y);
+  PiTable pi(y, threads);
   int64_t pi_sqrty = pi[isqrt(y)];
   int64_t pi_x13 = pi[x13];
   S2Status status(x);
@@ -64,7 +64,7 @@ T S2_easy_mpi_master(T x,
   threads = ideal_num_threads(threads, x13, 1000);
   vector<fastdiv_t> fastdiv = libdivide_vector(primes);
 
-  PiTable pi(y);
+  PiTable pi(y, threads);
   int64_t pi_sqrty = pi[isqrt(y)];
   int64_t pi_x13 = pi[x13];
   S2Status status(x);
@@ -20,6 +20,7 @@
 #include <fast_div.hpp>
 #include <generate.hpp>
 #include <int128.hpp>
+#include <LeafDensity.hpp>
 #include <min_max.hpp>
 #include <mpi_reduce_sum.hpp>
 #include <pmath.hpp>
@@ -333,7 +334,6 @@ T S2_hard_OpenMP_master(int64_t low,
                         int64_t y,
                         int64_t z,
                         int64_t c,
-                        T s2_hard_approx,
                         Primes& primes,
                         PiTable& pi,
                         FactorTable& factors,
@@ -422,14 +422,13 @@ void S2_hard_mpi_slave(T x,
                        int64_t y,
                        int64_t z,
                        int64_t c,
-                       T s2_hard_approx,
                        int threads)
 {
   // this will take a while to initialize
   FactorTable<F> factors(y, threads);
   int64_t max_prime = z / isqrt(y);
   vector<int64_t> primes = generate_primes<int64_t>(max_prime);
-  PiTable pi(max_prime);
+  PiTable pi(max_prime, threads);
 
   S2_hard_mpi_msg get_work;
 
@@ -444,7 +443,6 @@ void S2_hard_mpi_slave(T x,
                           get_work.segments_per_thread(),
                           get_work.rsd(),
                           x, y, z, c,
-                          s2_hard_approx,
                           primes, pi, factors,
                           proc_id,
                           threads);
@@ -474,6 +472,15 @@ int64_t start_mpi_slave_procs(int64_t z,
   return high;
 }
 
+/// Calibrate the S2_hard work estimate using the
+/// finished work [low, high] of a slave process.
+///
+void add_work(LeafDensity& density, const S2_hard_mpi_msg& msg, int threads)
+{
+  double seconds = msg.seconds() - msg.init_seconds();
+  density.add(msg.low(), msg.high() + 1, seconds * threads);
+}
+
 /// S2_hard MPI master process.
 /// Distributes the computation of the hard speacial leaves on
 /// cluster nodes.
@@ -483,7 +490,6 @@ T S2_hard_mpi_master(T x,
                      int64_t y,
                      int64_t z,
                      int64_t c,
-                     T s2_hard_approx,
                      int threads)
 {
   T s2_hard = 0;
@@ -494,6 +500,7 @@ T S2_hard_mpi_master(T x,
   int64_t high = start_mpi_slave_procs(z, segment_size, slave_procs);
   S2_hard_mpi_LoadBalancer balancer(high, y, z, slave_procs);
   S2Status status(x);
+  LeafDensity density(x, y, z, c);
 
   // main process scheduling loop
   while (true)
@@ -502,10 +509,11 @@ T S2_hard_mpi_master(T x,
     S2_hard_mpi_msg msg;
     msg.recv_any();
     s2_hard += msg.s2_hard<T>();
-    double percent = status.skewed_percent(s2_hard, s2_hard_approx);
+    add_work(density, msg, threads);
+    double percent = density.percent();
 
     if (print_status())
-      status.print(s2_hard, s2_hard_approx, msg.rsd());
+      status.print(density, threads * slave_procs, msg.rsd());
 
     // assign new work to do
     balancer.update(&msg, percent);
@@ -526,9 +534,10 @@ T S2_hard_mpi_master(T x,
     S2_hard_mpi_msg msg;
     msg.recv_any();
     s2_hard += msg.s2_hard<T>();
+    add_work(density, msg, threads);
 
     if (print_status())
-      status.print(s2_hard, s2_hard_approx, msg.rsd());
+      status.print(density, threads * slave_procs, msg.rsd());
 
     msg.send_finish();
   }
@@ -544,7 +553,6 @@ int64_t S2_hard_mpi(int64_t x,
                     int64_t y,
                     int64_t z,
                     int64_t c,
-                    int64_t s2_hard_approx,
                     int threads)
 {
   print("");
@@ -556,9 +564,9 @@ int64_t S2_hard_mpi(int64_t x,
   double time = get_wtime();
 
   if (is_mpi_master_proc())
-    s2_hard = S2_hard_mpi_master(x, y, z, c, s2_hard_approx, threads);
+    s2_hard = S2_hard_mpi_master(x, y, z, c, threads);
   else
-    S2_hard_mpi_slave<uint16_t>((intfast64_t) x, y, z, c, (intfast64_t) s2_hard_approx, threads);
+    S2_hard_mpi_slave<uint16_t>((intfast64_t) x, y, z, c, threads);
 
   print("S2_hard", s2_hard, time);
   return s2_hard;
@@ -570,7 +578,6 @@ int128_t S2_hard_mpi(int128_t x,
                      int64_t y,
                      int64_t z,
                      int64_t c,
-                     int128_t s2_hard_approx,
                      int threads)
 {
   print("");
@@ -582,14 +589,14 @@ int128_t S2_hard_mpi(int128_t x,
   double time = get_wtime();
 
   if (is_mpi_master_proc())
-    s2_hard = S2_hard_mpi_master(x, y, z, c, s2_hard_approx, threads);
+    s2_hard = S2_hard_mpi_master(x, y, z, c, threads);
   else
   {
     // uses less memory
     if (y <= FactorTable<uint16_t>::max())
-      S2_hard_mpi_slave<uint16_t>((intfast128_t) x, y, z, c, (intfast128_t) s2_hard_approx, threads);
+      S2_hard_mpi_slave<uint16_t>((intfast128_t) x, y, z, c, threads);
     else
-      S2_hard_mpi_slave<uint32_t>((intfast128_t) x, y, z, c, (intfast128_t) s2_hard_approx, threads);
+      S2_hard_mpi_slave<uint32_t>((intfast128_t) x, y, z, c, threads);
   }
 
   print("S2_hard", s2_hard, time);
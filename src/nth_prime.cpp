@@ -1,6 +1,11 @@
 ///
 /// @file  nth_prime.cpp
-/// @brief Find the nth prime
+/// @brief Find the nth prime. The nth prime is first approximated
+///        using the inverse Riemann R function, then pi(x) is
+///        computed at the approximation and finally the primes
+///        between the approximation and the nth prime are sieved.
+///        If that gap is large, computing pi(x) a second time
+///        at a corrected approximation is faster than sieving.
 ///
 /// Copyright (C) 2016 Kim Walisch, <kim.walisch@gmail.com>
 ///
@@ -12,20 +17,99 @@
 #include <primecount.hpp>
 #include <primesieve.hpp>
 #include <pmath.hpp>
+#include <int128.hpp>
 
 #include <stdint.h>
 #include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
 #include <string>
 
+using namespace std;
+using namespace primecount;
+
 namespace {
 
-const std::string max_n = "216289611853439384";
+/// pi(2^63 - 1)
+const string max_n = "216289611853439384";
+
+#ifdef HAVE_INT128_T
+
+/// pi(2^64 - 1)
+const string pi_max_uint64 = "425656284035217743";
+
+/// primesieve's nth prime is limited to
+/// primes <= primesieve::get_max_stop()
+///
+maxint_t get_max_prime()
+{
+  return (maxint_t) primesieve::get_max_stop();
+}
+
+/// Lower bound of pi(primesieve::get_max_stop()) using the
+/// Brun-Titchmarsh inequality (Montgomery & Vaughan):
+/// pi(x + y) - pi(x) <= 2y / log(y)
+///
+maxint_t get_max_n128()
+{
+  maxint_t max_n = to_maxint(pi_max_uint64);
+  uint64_t y = numeric_limits<uint64_t>::max() - primesieve::get_max_stop();
+
+  if (y > 1)
+    max_n -= (maxint_t) (2 * (double) y / log((double) y)) + 1;
+
+  return max_n;
+}
+
+#else
+
+maxint_t get_max_prime()
+{
+  return numeric_limits<int64_t>::max();
+}
+
+#endif
 
 // primes[1] = 2, primes[2] = 3, ...
 const int primes[] = { 0, 2, 3, 5, 7, 11, 13, 17, 19, 23 };
 
+/// Find the nth prime using a combination of the Deleglise-Rivat
+/// prime counting algorithm and the segmented sieve of Eratosthenes.
+/// @pre 10 <= n and the nth prime <= primesieve::get_max_stop()
+///
+maxint_t find_nth_prime(maxint_t n, int threads)
+{
+  primesieve::set_num_threads(threads);
+
+  if (n < 100000)
+    return primesieve::parallel_nth_prime((int64_t) n, 0);
+
+  maxint_t max_prime = get_max_prime();
+  maxint_t prime_approx = min(RiemannR_inverse(n), max_prime);
+  maxint_t count_approx = pi(prime_approx, threads);
+
+  // By the prime number theorem the nth prime is
+  // about (n - count_approx) * log(x) away
+  double log_approx = log((double) prime_approx);
+  maxint_t gap = (maxint_t) ((double) (n - count_approx) * log_approx);
+  maxint_t next_approx = min(prime_approx + gap, max_prime);
+
+  if (!is_sieve_gap(min(prime_approx, next_approx),
+                    max(prime_approx, next_approx)))
+  {
+    prime_approx = next_approx;
+    count_approx = pi(prime_approx, threads);
+  }
+
+  if (count_approx < n)
+    return primesieve::parallel_nth_prime((int64_t) (n - count_approx), (uint64_t) prime_approx);
+  else /* count_approx >= n */
+    return primesieve::parallel_nth_prime((int64_t) (n - count_approx - 1), (uint64_t) (prime_approx + 1));
 }
 
+} // namespace
+
 namespace primecount {
 
 /// Find the nth prime using a combination of the Deleglise-Rivat
@@ -42,27 +126,32 @@ int64_t nth_prime(int64_t n, int threads)
   if (n > to_maxint(max_n))
     throw primecount_error("nth_prime(n): n must be <= " + max_n);
 
-  int64_t prime = 0;
-  int64_t prime_approx = 0;
-  int64_t count_approx = 0;
-  primesieve::set_num_threads(threads);
+  return (int64_t) find_nth_prime(n, threads);
+}
 
-  if (n < 100000)
-    prime = primesieve::parallel_nth_prime(n, 0);
-  else
-  {
-    // Formula due to Dana Jacobsen:
-    // Nth prime ≈ Li^-1(n) + Li^-1(sqrt(n)) / 4
-    prime_approx = Li_inverse(n) + Li_inverse(isqrt(n)) / 4;
-    count_approx = pi(prime_approx, threads);
+#ifdef HAVE_INT128_T
 
-    if (count_approx < n)
-      prime = primesieve::parallel_nth_prime(n - count_approx, prime_approx);
-    else /* count_approx >= n */
-      prime = primesieve::parallel_nth_prime(n - count_approx - 1, prime_approx + 1);
+/// 128-bit variant of nth_prime(n, threads).
+/// @pre n <= pi(primesieve::get_max_stop())
+///
+int128_t nth_prime(int128_t n, int threads)
+{
+  // use 64-bit if possible
+  if (n <= to_maxint(max_n))
+    return nth_prime((int64_t) n, threads);
+
+  maxint_t max_n128 = get_max_n128();
+
+  if (n > max_n128)
+  {
+    ostringstream oss;
+    oss << "nth_prime(n): n must be <= " << max_n128;
+    throw primecount_error(oss.str());
   }
 
-  return prime;
+  return find_nth_prime(n, threads);
 }
 
+#endif
+
 } // namespace
@@ -0,0 +1,155 @@
+///
+/// @file  numa.cpp
+/// @brief Detect the NUMA nodes and their CPUs using the Linux
+///        sysfs (/sys/devices/system/node) and pin threads to
+///        NUMA nodes using sched_setaffinity(). This avoids a
+///        dependency on libnuma. On other operating systems NUMA
+///        is not supported and numa_nodes() returns 1.
+///
+/// Copyright (C) 2016 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <numa.hpp>
+#include <primecount-internal.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+  #include <sched.h>
+#endif
+
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
+using namespace std;
+
+namespace {
+
+/// CPUs of each NUMA node, empty if NUMA is disabled
+vector<vector<int> > node_cpus_;
+
+/// Parse a Linux cpulist e.g. "0-3,8-11"
+vector<int> parse_list(const string& str)
+{
+  vector<int> list;
+  istringstream iss(str);
+  string range;
+
+  while (getline(iss, range, ','))
+  {
+    istringstream in(range);
+    int first = 0;
+    int last = 0;
+    char dash = 0;
+
+    if (!(in >> first))
+      continue;
+    if (!(in >> dash >> last) || dash != '-')
+      last = first;
+
+    for (int i = first; i <= last; i++)
+      list.push_back(i);
+  }
+
+  return list;
+}
+
+string read_line(const string& filename)
+{
+  ifstream file(filename.c_str());
+  string line;
+  getline(file, line);
+  return line;
+}
+
+/// Get the CPUs of each NUMA node, NUMA nodes
+/// without CPUs (memory only nodes) are skipped.
+///
+vector<vector<int> > get_node_cpus()
+{
+  vector<vector<int> > node_cpus;
+  string path = "/sys/devices/system/node/";
+  vector<int> nodes = parse_list(read_line(path + "online"));
+
+  for (size_t i = 0; i < nodes.size(); i++)
+  {
+    ostringstream filename;
+    filename << path << "node" << nodes[i] << "/cpulist";
+    vector<int> cpus = parse_list(read_line(filename.str()));
+    if (!cpus.empty())
+      node_cpus.push_back(cpus);
+  }
+
+  return node_cpus;
+}
+
+int get_thread_num()
+{
+#ifdef _OPENMP
+  return omp_get_thread_num();
+#else
+  return 0;
+#endif
+}
+
+} // namespace
+
+namespace primecount {
+
+void set_numa(bool enable)
+{
+  node_cpus_.clear();
+
+#if defined(__linux__)
+  if (enable)
+    node_cpus_ = get_node_cpus();
+#else
+  unused_param(enable);
+#endif
+}
+
+int numa_nodes()
+{
+  return max((int) node_cpus_.size(), 1);
+}
+
+NumaBinding::NumaBinding()
+  : node_(get_thread_num() % numa_nodes()),
+    is_bound_(false)
+{
+#if defined(__linux__)
+  if (!node_cpus_.empty())
+  {
+    const vector<int>& cpus = node_cpus_[node_];
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+
+    for (size_t i = 0; i < cpus.size(); i++)
+      if (cpus[i] < CPU_SETSIZE)
+        CPU_SET(cpus[i], &cpuset);
+
+    // if pinning fails the thread still uses
+    // the table of its NUMA node, only slower
+    is_bound_ = sched_getaffinity(0, sizeof(old_cpuset_), &old_cpuset_) == 0 &&
+                sched_setaffinity(0, sizeof(cpuset), &cpuset) == 0;
+  }
+#endif
+}
+
+NumaBinding::~NumaBinding()
+{
+#if defined(__linux__)
+  if (is_bound_)
+    sched_setaffinity(0, sizeof(old_cpuset_), &old_cpuset_);
+#endif
+}
+
+} // namespace
@@ -31,6 +31,7 @@
 #include <PiTable.hpp>
 #include <primecount-internal.hpp>
 #include <primecount.hpp>
+#include <EventCounters.hpp>
 #include <generate.hpp>
 #include <pmath.hpp>
 #include <PhiTiny.hpp>
@@ -65,6 +66,11 @@ public:
     cache_.resize(size);
   }
 
+  ~PhiCache()
+  {
+    events_.merge();
+  }
+
   /// Calculate phi(x, a) using the recursive formula:
   /// phi(x, a) = phi(x, a - 1) - phi(x / primes_[a], a - 1)
   ///
@@ -105,9 +111,15 @@ public:
       {
         int64_t x2 = fast_div(x, primes_[a2 + 1]);
         if (is_cached(x2, a2))
+        {
           sum += cache_[a2][x2] * -SIGN;
+          COUNT_EVENT(events_, PHI_CACHE_HITS, 1);
+        }
         else
+        {
           sum += phi<-SIGN>(x2, a2);
+          COUNT_EVENT(events_, PHI_CACHE_MISSES, 1);
+        }
       }
     }
 
@@ -130,6 +142,7 @@ private:
   vector<int32_t>& primes_;
   PiTable& pi_;
   int64_t bytes_;
+  EventCounters events_;
 
   int64_t cache_size(int64_t a) const
   {
@@ -201,7 +214,7 @@ int64_t phi(int64_t x, int64_t a, int threads)
     {
       // use a large pi(x) lookup table for speed
       int64_t sqrtx = isqrt(x);
-      PiTable pi(max(sqrtx, primes[a]));
+      PiTable pi(max(sqrtx, primes[a]), threads);
       PhiCache cache(primes, pi);
 
       int64_t pi_sqrtx = min(pi[sqrtx], a); 
@@ -23,4 +23,18 @@ int64_t pi_primesieve(int64_t x, int threads)
   return primesieve::parallel_count_primes(0, x);
 }
 
+/// Count the primes inside [a, b] using
+/// the segmented sieve of Eratosthenes.
+///
+int64_t pi_primesieve(int64_t a, int64_t b, int threads)
+{
+  if (a < 0)
+    a = 0;
+  if (b < 2 || a > b)
+    return 0;
+
+  primesieve::set_num_threads(threads);
+  return primesieve::parallel_count_primes(a, b);
+}
+
 } // namespace
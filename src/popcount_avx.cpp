@@ -0,0 +1,196 @@
+///
+/// @file  popcount_avx.cpp
+/// @brief Count the number of 1 bits in large arrays using AVX2
+///        or AVX-512 VPOPCNTDQ. The kernels are compiled using
+///        GCC's target attribute so that primecount runs on all
+///        x86 CPUs, the fastest kernel supported by the CPU is
+///        selected at runtime using __builtin_cpu_supports().
+///
+///        The AVX2 kernel uses the Harley-Seal algorithm with
+///        256-bit carry-save adders, see: Wojciech Muła, Nathan
+///        Kurz, Daniel Lemire, "Faster Population Counts Using
+///        AVX2 Instructions", arXiv:1611.07612, 2016.
+///
+/// Copyright (C) 2016 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <popcount.hpp>
+
+#if defined(HAVE_POPCOUNT_AVX)
+
+#include <stdint.h>
+#include <immintrin.h>
+
+using namespace std;
+using namespace primecount;
+
+namespace {
+
+#if defined(HAVE_AVX2)
+
+/// Count the 1 bits of each byte using a 4-bit
+/// lookup table, sum up the counts of each 64-bit lane.
+///
+__attribute__ ((target ("avx2")))
+__m256i popcount256(__m256i v)
+{
+  const __m256i lookup = _mm256_setr_epi8(
+      0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+      0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+
+  const __m256i low_mask = _mm256_set1_epi8(0x0f);
+  __m256i lo = _mm256_and_si256(v, low_mask);
+  __m256i hi = _mm256_and_si256(_mm256_srli_epi32(v, 4), low_mask);
+  __m256i cnt1 = _mm256_shuffle_epi8(lookup, lo);
+  __m256i cnt2 = _mm256_shuffle_epi8(lookup, hi);
+  __m256i cnt = _mm256_add_epi8(cnt1, cnt2);
+
+  return _mm256_sad_epu8(cnt, _mm256_setzero_si256());
+}
+
+/// Carry-save adder (CSA).
+/// @see Chapter 5 in "Hacker's Delight" 2nd edition.
+///
+__attribute__ ((target ("avx2")))
+void CSA256(__m256i& h, __m256i& l, __m256i a, __m256i b, __m256i c)
+{
+  __m256i u = _mm256_xor_si256(a, b);
+  h = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(u, c));
+  l = _mm256_xor_si256(u, c);
+}
+
+/// Harley-Seal popcount using 256-bit vectors,
+/// processes 16 vectors (64 words) per iteration.
+///
+__attribute__ ((target ("avx2")))
+uint64_t popcount_avx2(const uint64_t* array, uint64_t size)
+{
+  const __m256i* data = (const __m256i*) array;
+  uint64_t vectors = size / 4;
+  uint64_t limit = vectors - vectors % 16;
+  uint64_t i = 0;
+
+  __m256i total = _mm256_setzero_si256();
+  __m256i ones = _mm256_setzero_si256();
+  __m256i twos = _mm256_setzero_si256();
+  __m256i fours = _mm256_setzero_si256();
+  __m256i eights = _mm256_setzero_si256();
+  __m256i sixteens;
+  __m256i twosA, twosB, foursA, foursB, eightsA, eightsB;
+
+  for (; i < limit; i += 16)
+  {
+    CSA256(twosA, ones, ones, _mm256_loadu_si256(data + i + 0), _mm256_loadu_si256(data + i + 1));
+    CSA256(twosB, ones, ones, _mm256_loadu_si256(data + i + 2), _mm256_loadu_si256(data + i + 3));
+    CSA256(foursA, twos, twos, twosA, twosB);
+    CSA256(twosA, ones, ones, _mm256_loadu_si256(data + i + 4), _mm256_loadu_si256(data + i + 5));
+    CSA256(twosB, ones, ones, _mm256_loadu_si256(data + i + 6), _mm256_loadu_si256(data + i + 7));
+    CSA256(foursB, twos, twos, twosA, twosB);
+    CSA256(eightsA, fours, fours, foursA, foursB);
+    CSA256(twosA, ones, ones, _mm256_loadu_si256(data + i + 8), _mm256_loadu_si256(data + i + 9));
+    CSA256(twosB, ones, ones, _mm256_loadu_si256(data + i + 10), _mm256_loadu_si256(data + i + 11));
+    CSA256(foursA, twos, twos, twosA, twosB);
+    CSA256(twosA, ones, ones, _mm256_loadu_si256(data + i + 12), _mm256_loadu_si256(data + i + 13));
+    CSA256(twosB, ones, ones, _mm256_loadu_si256(data + i + 14), _mm256_loadu_si256(data + i + 15));
+    CSA256(foursB, twos, twos, twosA, twosB);
+    CSA256(eightsB, fours, fours, foursA, foursB);
+    CSA256(sixteens, eights, eights, eightsA, eightsB);
+
+    total = _mm256_add_epi64(total, popcount256(sixteens));
+  }
+
+  total = _mm256_slli_epi64(total, 4);
+  total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount256(eights), 3));
+  total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount256(fours), 2));
+  total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount256(twos), 1));
+  total = _mm256_add_epi64(total, popcount256(ones));
+
+  for (; i < vectors; i++)
+    total = _mm256_add_epi64(total, popcount256(_mm256_loadu_si256(data + i)));
+
+  uint64_t cnt = (uint64_t) _mm256_extract_epi64(total, 0) +
+                 (uint64_t) _mm256_extract_epi64(total, 1) +
+                 (uint64_t) _mm256_extract_epi64(total, 2) +
+                 (uint64_t) _mm256_extract_epi64(total, 3);
+
+  for (i *= 4; i < size; i++)
+    cnt += popcnt_u64(array[i]);
+
+  return cnt;
+}
+
+#endif
+
+#if defined(HAVE_AVX512_VPOPCNTDQ)
+
+/// Count 8 words per iteration using the VPOPCNTQ
+/// instruction, the last words are counted using
+/// a masked load.
+///
+__attribute__ ((target ("avx512f,avx512vpopcntdq")))
+uint64_t popcount_avx512(const uint64_t* array, uint64_t size)
+{
+  __m512i total = _mm512_setzero_si512();
+  uint64_t i = 0;
+
+  for (; i + 8 <= size; i += 8)
+  {
+    __m512i v = _mm512_loadu_si512((const void*) &array[i]);
+    total = _mm512_add_epi64(total, _mm512_popcnt_epi64(v));
+  }
+
+  if (i < size)
+  {
+    __mmask8 mask = (__mmask8) (0xff >> (i + 8 - size));
+    __m512i v = _mm512_maskz_loadu_epi64(mask, (const void*) &array[i]);
+    total = _mm512_add_epi64(total, _mm512_popcnt_epi64(v));
+  }
+
+  uint64_t lanes[8];
+  _mm512_storeu_si512((void*) lanes, total);
+  uint64_t cnt = 0;
+
+  for (int j = 0; j < 8; j++)
+    cnt += lanes[j];
+
+  return cnt;
+}
+
+#endif
+
+typedef uint64_t (*popcount_t)(const uint64_t*, uint64_t);
+
+/// Select the fastest popcount
+/// kernel supported by the CPU.
+///
+popcount_t get_popcount_kernel()
+{
+#if defined(HAVE_AVX512_VPOPCNTDQ)
+  if (__builtin_cpu_supports("avx512vpopcntdq"))
+    return popcount_avx512;
+#endif
+
+#if defined(HAVE_AVX2)
+  if (__builtin_cpu_supports("avx2"))
+    return popcount_avx2;
+#endif
+
+  return popcnt_array;
+}
+
+} // namespace
+
+namespace primecount {
+
+uint64_t popcount_avx(const uint64_t* array, uint64_t size)
+{
+  static const popcount_t popcount_kernel = get_popcount_kernel();
+  return popcount_kernel(array, size);
+}
+
+} // namespace
+
+#endif
@@ -13,6 +13,10 @@
 #include <calculator.hpp>
 #include <int128.hpp>
 #include <pmath.hpp>
+#include <primesieve.hpp>
+#include <print.hpp>
+#include <ResultCache.hpp>
+#include <TableCache.hpp>
 
 #include <algorithm>
 #include <ctime>
@@ -20,12 +24,21 @@
 #include <limits>
 #include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
 #include <stdint.h>
 
 #ifdef _OPENMP
   #include <omp.h>
 #endif
 
+#if defined(_WIN32)
+  #define NOMINMAX
+  #include <windows.h>
+#else
+  #include <unistd.h>
+#endif
+
 #ifdef HAVE_MPI
 
 #include <mpi.h>
@@ -61,6 +74,7 @@ bool is_mpi_master_proc()
 #endif
 
 using namespace std;
+using namespace primecount;
 
 namespace {
 
@@ -72,9 +86,128 @@ int status_precision_ = -1;
 
 double alpha_ = -1;
 
+/// FactorTable wheel: 210 or 2310
+int wheel_ = 2310;
+
 // Below 10^7 the Deleglise-Rivat algorithm is slower than LMO
 const int deleglise_rivat_threshold = 10000000;
 
+/// Seconds per operation of the Deleglise-Rivat algorithm
+/// divided by seconds per operation of the segmented sieve
+/// of Eratosthenes (primesieve), measured on x86-64.
+///
+const double deleglise_rivat_cost = 45000;
+
+/// Operations of pi(x) using the Deleglise-Rivat
+/// algorithm: O(x^(2/3) / (log x)^2)
+///
+double deleglise_rivat_operations(double x)
+{
+  if (x < 10)
+    return 0;
+
+  double logx = log(x);
+  return pow(x, 2.0 / 3.0) / (logx * logx);
+}
+
+/// Sieving [a, b] takes about (b - a + sqrt(b)) * log(log(b))
+/// operations, the sieving primes <= sqrt(b) are included.
+///
+double sieve_operations(maxint_t a, maxint_t b)
+{
+  double x = (double) b;
+  return ((double) (b - a) + sqrt(x)) * log(log(x));
+}
+
+/// Built-in LMO alpha, used if there is no --tune profile
+double alpha_lmo_formula(double x)
+{
+  double a = 0.00156512;
+  double b = -0.0261411;
+  double c = 0.990948;
+  double logx = log(x);
+
+  return a * pow(logx, 2) + b * logx + c;
+}
+
+/// Built-in Deleglise-Rivat alpha, used if
+/// there is no --tune profile.
+///
+double alpha_deleglise_rivat_formula(double x)
+{
+  if (x <= 1e21)
+  {
+    double a = 0.000711339;
+    double b = -0.0160586;
+    double c = 0.123034;
+    double d = 0.802942;
+    double logx = log(x);
+
+    return a * pow(logx, 3) + b * pow(logx, 2) + c * logx + d;
+  }
+  else
+  {
+    // Because of CPU cache misses sieving (S2_hard(x) and P2(x))
+    // becomes the main bottleneck above 10^21 . Hence we use a
+    // different alpha formula when x > 10^21 which returns a larger
+    // alpha which reduces sieving but increases S2_easy(x) work.
+    double a = 0.00149066;
+    double b = -0.0375705;
+    double c = 0.282139;
+    double d = 0.591972;
+    double logx = log(x);
+
+    return a * pow(logx, 3) + b * pow(logx, 2) + c * logx + d;
+  }
+}
+
+void print_range(maxint_t a, maxint_t b, const string& method)
+{
+  ostringstream oss;
+  print("");
+  print("=== pi_range(a, b) ===");
+  oss << "a = " << a << ", b = " << b;
+  print(oss.str());
+  print("Method: " + method);
+}
+
+/// Keeps the lookup tables in memory while in scope
+class TableStore
+{
+public:
+  TableStore() { primecount::set_table_store(true); }
+  ~TableStore() { primecount::set_table_store(false); }
+};
+
+/// Compute the queries from the largest to the smallest x
+/// so that the lookup tables built for the largest x
+/// (largest y and z) are reused for all other x.
+///
+template <typename T>
+vector<T> pi_batch(const vector<T>& xs, int threads)
+{
+  vector<pair<T, size_t> > queries;
+
+  for (size_t i = 0; i < xs.size(); i++)
+    queries.push_back(make_pair(xs[i], i));
+
+  sort(queries.rbegin(), queries.rend());
+  vector<T> pix(xs.size(), 0);
+  TableStore store;
+
+  for (size_t i = 0; i < queries.size(); i++)
+  {
+    size_t j = queries[i].second;
+
+    if (i > 0 && queries[i].first == queries[i - 1].first)
+      pix[j] = pix[queries[i - 1].second];
+    else
+      pix[j] = primecount::pi(queries[i].first, threads);
+  }
+
+  return pix;
+}
+
 }
 
 namespace primecount {
@@ -88,8 +221,15 @@ int64_t pi(int64_t x, int threads)
 {
   if (x < deleglise_rivat_threshold)
     return pi_lmo(x, threads);
-  else
-    return pi_deleglise_rivat(x, threads);
+
+  maxint_t res;
+  if (result_cache_find(x, threads, &res))
+    return (int64_t) res;
+
+  int64_t pix = pi_deleglise_rivat(x, threads);
+  result_cache_add(x, pix);
+
+  return pix;
 }
 
 #ifdef HAVE_INT128_T
@@ -104,8 +244,15 @@ int128_t pi(int128_t x, int threads)
   // use 64-bit if possible
   if (x <= numeric_limits<int64_t>::max())
     return pi((int64_t) x, threads);
-  else
-    return pi_deleglise_rivat(x, threads);
+
+  int128_t res;
+  if (result_cache_find(x, threads, &res))
+    return res;
+
+  int128_t pix = pi_deleglise_rivat(x, threads);
+  result_cache_add(x, pix);
+
+  return pix;
 }
 
 #endif
@@ -131,6 +278,147 @@ string pi(const string& x, int threads)
   return oss.str();
 }
 
+vector<int64_t> pi(const vector<int64_t>& xs)
+{
+  return pi(xs, get_num_threads());
+}
+
+vector<int64_t> pi(const vector<int64_t>& xs, int threads)
+{
+  return pi_batch(xs, threads);
+}
+
+/// Batch pi(xs) of integer arithmetic expressions.
+/// @pre xs <= get_max_x().
+///
+vector<string> pi(const vector<string>& xs)
+{
+  return pi(xs, get_num_threads());
+}
+
+vector<string> pi(const vector<string>& xs, int threads)
+{
+  vector<maxint_t> x;
+
+  for (size_t i = 0; i < xs.size(); i++)
+    x.push_back(to_maxint(xs[i]));
+
+  vector<maxint_t> pix = pi_batch(x, threads);
+  vector<string> res;
+
+  for (size_t i = 0; i < pix.size(); i++)
+  {
+    ostringstream oss;
+    oss << pix[i];
+    res.push_back(oss.str());
+  }
+
+  return res;
+}
+
+int64_t pi_range(int64_t a, int64_t b)
+{
+  return pi_range(a, b, get_num_threads());
+}
+
+string pi_range(const string& a, const string& b)
+{
+  return pi_range(a, b, get_num_threads());
+}
+
+string pi_range(const string& a, const string& b, int threads)
+{
+  maxint_t res = pi_range(to_maxint(a), to_maxint(b), threads);
+  ostringstream oss;
+  oss << res;
+  return oss.str();
+}
+
+bool is_sieve_range(maxint_t a, maxint_t b)
+{
+  if (b > numeric_limits<int64_t>::max())
+    return false;
+  if (b < 100)
+    return true;
+
+  double sieve = sieve_operations(a, b);
+  double deleglise_rivat = deleglise_rivat_operations((double) b) +
+                           deleglise_rivat_operations((double) (a - 1));
+
+  return sieve < deleglise_rivat * deleglise_rivat_cost;
+}
+
+/// primesieve sieves up to get_max_stop() ~ 2^64,
+/// the gap may hence exceed 2^63.
+///
+bool is_sieve_gap(maxint_t a, maxint_t b)
+{
+#ifdef HAVE_INT128_T
+  if (b > (maxint_t) primesieve::get_max_stop())
+    return false;
+#endif
+  if (b < 100)
+    return true;
+
+  double sieve = sieve_operations(a, b);
+  double deleglise_rivat = deleglise_rivat_operations((double) b);
+
+  return sieve < deleglise_rivat * deleglise_rivat_cost;
+}
+
+/// Count the primes inside [a, b] using either the
+/// segmented sieve of Eratosthenes or pi(b) - pi(a - 1).
+/// The two pi(x) computations share their lookup tables.
+///
+int64_t pi_range(int64_t a, int64_t b, int threads)
+{
+  if (a < 2)
+    a = 2;
+  if (a > b)
+    return 0;
+
+  if (is_sieve_range(a, b))
+  {
+    print_range(a, b, "segmented sieve of Eratosthenes");
+    return pi_primesieve(a, b, threads);
+  }
+
+  print_range(a, b, "pi(b) - pi(a - 1)");
+  vector<int64_t> xs;
+  xs.push_back(b);
+  xs.push_back(a - 1);
+  vector<int64_t> pix = pi_batch(xs, threads);
+
+  return pix[0] - pix[1];
+}
+
+#ifdef HAVE_INT128_T
+
+/// primesieve only supports 64-bit integers,
+/// hence for b >= 2^63 pi(b) - pi(a - 1) is used.
+///
+int128_t pi_range(int128_t a, int128_t b, int threads)
+{
+  if (a < 2)
+    a = 2;
+  if (a > b)
+    return 0;
+
+  // use 64-bit if possible
+  if (b <= numeric_limits<int64_t>::max())
+    return pi_range((int64_t) a, (int64_t) b, threads);
+
+  print_range(a, b, "pi(b) - pi(a - 1)");
+  vector<int128_t> xs;
+  xs.push_back(b);
+  xs.push_back(a - 1);
+  vector<int128_t> pix = pi_batch(xs, threads);
+
+  return pix[0] - pix[1];
+}
+
+#endif
+
 /// Calculate the number of primes below x using the
 /// Deleglise-Rivat algorithm.
 /// Run time: O(x^(2/3) / (log x)^2) operations, O(x^(1/3) * (log x)^3) space.
@@ -235,6 +523,22 @@ int64_t nth_prime(int64_t n)
   return nth_prime(n, get_num_threads());
 }
 
+/// 128-bit variant of nth_prime(n).
+/// @param n  integer arithmetic expression e.g. "10^17".
+///
+string nth_prime(const string& n)
+{
+  return nth_prime(n, get_num_threads());
+}
+
+string nth_prime(const string& n, int threads)
+{
+  maxint_t prime = nth_prime(to_maxint(n), threads);
+  ostringstream oss;
+  oss << prime;
+  return oss.str();
+}
+
 /// Partial sieve function (a.k.a. Legendre-sum).
 /// phi(x, a) counts the numbers <= x that are not divisible
 /// by any of the first a primes.
@@ -279,6 +583,16 @@ double get_wtime()
 #endif
 }
 
+/// Suspend the calling thread
+void sleep_us(int64_t microseconds)
+{
+#if defined(_WIN32)
+  Sleep((DWORD) max((int64_t) 1, microseconds / 1000));
+#else
+  usleep((useconds_t) microseconds);
+#endif
+}
+
 int ideal_num_threads(int threads, int64_t sieve_limit, int64_t thread_threshold)
 {
   thread_threshold = max((int64_t) 1, thread_threshold);
@@ -297,6 +611,19 @@ double get_alpha()
   return alpha_;
 }
 
+void set_wheel(int wheel)
+{
+  if (wheel != 210 && wheel != 2310)
+    throw primecount_error("wheel must be 210 or 2310");
+
+  wheel_ = wheel;
+}
+
+int get_wheel()
+{
+  return wheel_;
+}
+
 double get_alpha(maxint_t x, int64_t y)
 {
   // y = x13 * alpha, thus alpha = y / x13
@@ -314,15 +641,9 @@ double get_alpha_lmo(maxint_t x)
   double alpha = get_alpha();
 
   // use default alpha if no command-line alpha provided
-  if (alpha < 1)
-  {
-    double a = 0.00156512;
-    double b = -0.0261411;
-    double c = 0.990948;
-    double logx = log((double) x);
-
-    alpha = a * pow(logx, 2) + b * logx + c;
-  }
+  if (alpha < 1 &&
+      !get_alpha_profile("lmo", x, alpha_lmo_formula, &alpha))
+    alpha = alpha_lmo_formula((double) x);
 
   return in_between(1, alpha, iroot<6>(x));
 }
@@ -340,30 +661,14 @@ double get_alpha_deleglise_rivat(maxint_t x)
   // use default alpha if no command-line alpha provided
   if (alpha < 1)
   {
-    if (x2 <= 1e21)
-    {
-      double a = 0.000711339;
-      double b = -0.0160586;
-      double c = 0.123034;
-      double d = 0.802942;
-      double logx = log(x2);
-
-      alpha = a * pow(logx, 3) + b * pow(logx, 2) + c * logx + d;
-    }
+    // use the alpha profile generated by --tune
+    if (get_alpha_profile("deleglise_rivat", x, alpha_deleglise_rivat_formula, &alpha))
+      alpha = max(alpha, 1.0);
     else
-    {
-      // Because of CPU cache misses sieving (S2_hard(x) and P2(x))
-      // becomes the main bottleneck above 10^21 . Hence we use a
-      // different alpha formula when x > 10^21 which returns a larger
-      // alpha which reduces sieving but increases S2_easy(x) work.
-      double a = 0.00149066;
-      double b = -0.0375705;
-      double c = 0.282139;
-      double d = 0.591972;
-      double logx = log(x2);
-
-      alpha = a * pow(logx, 3) + b * pow(logx, 2) + c * logx + d;
-    }
+      alpha = alpha_deleglise_rivat_formula(x2);
+
+    alpha = in_between(1, alpha, iroot<6>(x));
+    alpha = fit_memory_alpha(x, alpha);
   }
 
   return in_between(1, alpha, iroot<6>(x));
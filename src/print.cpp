@@ -8,12 +8,14 @@
 ///
 
 #include <print.hpp>
+#include <PerfCounters.hpp>
 #include <primecount-internal.hpp>
 #include <int128.hpp>
 #include <stdint.h>
 
 #include <iostream>
 #include <iomanip>
+#include <map>
 #include <string>
 
 using namespace std;
@@ -24,6 +26,9 @@ bool print_status_ = false;
 
 bool print_variables_ = false;
 
+/// Seconds of each formula e.g. "S2_hard"
+map<string, double> timings_;
+
 }
 
 namespace primecount {
@@ -125,6 +130,8 @@ void print(maxint_t x, int64_t y, int64_t c, int threads)
 
 void print(const string& res_str, maxint_t res, double time)
 {
+  timings_[res_str] += get_wtime() - time;
+
   if (print_status())
   {
     cout << "\r" << string(50,' ') << "\r";
@@ -132,6 +139,18 @@ void print(const string& res_str, maxint_t res, double time)
     cout << res_str << " = " << res << endl;
     print_seconds(get_wtime() - time);
   }
+
+  add_perf_stage(res_str);
+}
+
+map<string, double> get_timings()
+{
+  return timings_;
+}
+
+void reset_timings()
+{
+  timings_.clear();
 }
 
 void print_seconds(double seconds)
@@ -14,12 +14,14 @@
 #include <int128.hpp>
 
 #include <stdint.h>
+#include <algorithm>
 #include <iostream>
 #include <cstdlib>
 #include <string>
 #include <exception>
 #include <sstream>
 #include <ctime>
+#include <vector>
 
 #ifdef _OPENMP
   #include <omp.h>
@@ -62,6 +64,29 @@ int get_rand()
   return (rand() % 10000) * 1000 + 1;
 }
 
+/// Fisher-Yates shuffle using rand(), unlike
+/// random_shuffle() (removed in C++17) the order
+/// only depends on the seed passed to srand().
+///
+template <typename T>
+void shuffle_rand(vector<T>& v)
+{
+  for (size_t i = v.size(); i > 1; i--)
+    swap(v[i - 1], v[rand() % i]);
+}
+
+/// The seed is $PRIMECOUNT_TEST_SEED if set, this
+/// way a failed test can be reproduced.
+///
+unsigned get_seed()
+{
+  const char* seed = getenv("PRIMECOUNT_TEST_SEED");
+  if (seed)
+    return (unsigned) strtoul(seed, 0, 10);
+
+  return static_cast<unsigned>(time(0));
+}
+
 void check_equal(const string& f1, int64_t x, int64_t res1, int64_t res2)
 {
   if (res1 != res2)
@@ -99,6 +124,84 @@ void check_nth_prime(int64_t iters)
   cout << endl;
 }
 
+#ifdef HAVE_INT128_T
+
+/// The 128-bit nth_prime(n) must match the 64-bit
+/// nth_prime(n) and reject n > pi(2^64 - 1).
+///
+void check_nth_prime128(int64_t iters)
+{
+  cout << "Testing nth_prime(x) 128-bit" << flush;
+
+  for (int64_t i = 0; i < iters; i++)
+  {
+    int64_t n = (int64_t) get_rand() * (i + 1);
+    int128_t n128 = n;
+    check_equal("nth_prime", n, (int64_t) nth_prime(n128, get_num_threads()), nth_prime(n, get_num_threads()));
+    double percent = 100.0 * (i + 1.0) / iters;
+    cout << "\rTesting nth_prime(x) 128-bit " << (int) percent << "%" << flush;
+  }
+
+  bool is_error = false;
+
+  try
+  {
+    // pi(2^64 - 1) + 1
+    int128_t n = to_maxint("425656284035217744");
+    nth_prime(n, get_num_threads());
+  }
+  catch (primecount_error&)
+  {
+    is_error = true;
+  }
+
+  if (!is_error)
+    throw primecount_error("nth_prime(n) must fail for n > pi(2^64 - 1)");
+
+  cout << endl;
+}
+
+#endif
+
+void check_pi_batch(int64_t iters)
+{
+  cout << "Testing pi(xs)" << flush;
+
+  vector<int64_t> xs;
+  int64_t x = 0;
+
+  for (int64_t i = 0; i < iters; i++, x += get_rand() * 10)
+    xs.push_back(x);
+
+  // duplicates and unsorted queries
+  xs.push_back(xs[iters / 2]);
+  shuffle_rand(xs);
+  vector<int64_t> res = pi(xs, get_num_threads());
+
+  for (size_t i = 0; i < xs.size(); i++)
+    check_equal("pi(xs)", xs[i], res[i], pi(xs[i], get_num_threads()));
+
+  cout << "\rTesting pi(xs) 100%" << endl;
+}
+
+void check_pi_range(int64_t iters)
+{
+  cout << "Testing pi_range(a, b)" << flush;
+
+  for (int64_t i = 0; i < iters; i++)
+  {
+    // small ranges are sieved, large ranges use pi(x)
+    int64_t a = (int64_t) get_rand() * 1000;
+    int64_t b = a + (int64_t) get_rand() * ((i % 2) ? 1000 : 1);
+    int64_t res = pi(b, get_num_threads()) - pi(a - 1, get_num_threads());
+    check_equal("pi_range", b, pi_range(a, b, get_num_threads()), res);
+    double percent = 100.0 * (i + 1.0) / iters;
+    cout << "\rTesting pi_range(a, b) " << (int) percent << "%" << flush;
+  }
+
+  cout << endl;
+}
+
 #ifdef _OPENMP
 
 void test_phi_thread_safety(int64_t iters)
@@ -130,7 +233,9 @@ namespace primecount {
 bool test()
 {
   set_print_status(false); 
-  srand(static_cast<unsigned>(time(0)));
+  unsigned seed = get_seed();
+  srand(seed);
+  cout << "Random seed: " << seed << endl;
 
   try
   {
@@ -159,6 +264,13 @@ bool test()
 #endif
 
     check_nth_prime(300);
+
+#ifdef HAVE_INT128_T
+    check_nth_prime128(50);
+#endif
+
+    check_pi_batch(100);
+    check_pi_range(100);
   }
   catch (exception& e)
   {
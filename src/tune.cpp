@@ -0,0 +1,445 @@
+///
+/// @file   tune.cpp
+/// @brief  Find the fastest alpha tuning factors for the current
+///         machine (primecount --tune). For x = 10^10, 10^10.5, ...
+///         we time the formulas whose run time depends on alpha,
+///         i.e. P2(x, y), S2_easy(x, y) and S2_hard(x, y) for the
+///         Deleglise-Rivat algorithm and pi_lmo(x) for the LMO
+///         algorithm, using different alphas. P2(x, y) and
+///         S2_hard(x, y) are only timed over a sample of their
+///         work which is extrapolated. Then we fit the fastest
+///         alphas to the models used in primecount.cpp:
+///
+///         Deleglise-Rivat: alpha = a t^3 + b t^2 + c t + d
+///         LMO:             alpha = a t^2 + b t + c
+///
+///         Where t is log(x) centered and scaled to [-1, 1] over
+///         the tuned range, which keeps the least squares fit well
+///         conditioned. The fitted coefficients are saved to the
+///         alpha profile file which is loaded by
+///         get_alpha_deleglise_rivat() and get_alpha_lmo(). Outside
+///         of the tuned range the built-in formula is scaled by the
+///         ratio of the profile to the built-in formula at the
+///         nearest end of the tuned range.
+///
+/// Copyright (C) 2016 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primecount-internal.hpp>
+#include <primecount.hpp>
+#include <PhiTiny.hpp>
+#include <S1.hpp>
+#include <S2.hpp>
+#include <pmath.hpp>
+#include <int128.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace primecount;
+
+namespace {
+
+struct AlphaProfile
+{
+  AlphaProfile() : min_x(0), max_x(0) { }
+  double min_x;
+  double max_x;
+  vector<double> coefficients;
+};
+
+const string profile_header = "primecount-alpha";
+
+/// Increase if the profile format changes
+const int profile_version = 2;
+
+/// Percent of the S2_hard(x, y) work which is timed
+const double S2_hard_sample_percent = 10;
+
+/// Only accessed inside critical (alpha_profile)
+bool is_loaded_ = false;
+
+bool ignore_profile_ = false;
+
+AlphaProfile deleglise_rivat_;
+
+AlphaProfile lmo_;
+
+/// The alpha profile file is $PRIMECOUNT_PROFILE
+/// or ~/.primecount_alpha by default.
+///
+string get_profile_file()
+{
+  const char* file = getenv("PRIMECOUNT_PROFILE");
+  if (file)
+    return file;
+
+  const char* home = getenv("HOME");
+  if (!home)
+    home = getenv("USERPROFILE");
+  if (!home)
+    return ".primecount_alpha";
+
+  return string(home) + "/.primecount_alpha";
+}
+
+/// Profile file format, a header line followed by
+/// one line per algorithm:
+/// primecount-alpha <version>
+/// <algorithm> <min_x> <max_x> <coefficients...>
+///
+void load_profile()
+{
+  is_loaded_ = true;
+  ifstream file(get_profile_file().c_str());
+  string header;
+  string line;
+  int version = 0;
+
+  // profiles of older versions are ignored
+  if (!(file >> header >> version) ||
+      header != profile_header ||
+      version != profile_version)
+    return;
+
+  getline(file, line);
+
+  while (getline(file, line))
+  {
+    istringstream iss(line);
+    string name;
+    AlphaProfile profile;
+    double coefficient;
+
+    if (!(iss >> name >> profile.min_x >> profile.max_x))
+      continue;
+    while (iss >> coefficient)
+      profile.coefficients.push_back(coefficient);
+
+    if (name == "deleglise_rivat" && profile.coefficients.size() == 4)
+      deleglise_rivat_ = profile;
+    if (name == "lmo" && profile.coefficients.size() == 3)
+      lmo_ = profile;
+  }
+}
+
+void save_profile()
+{
+  string filename = get_profile_file();
+  ofstream file(filename.c_str());
+
+  if (!file)
+    throw primecount_error("failed to write " + filename);
+
+  file << setprecision(17);
+  file << profile_header << " " << profile_version << endl;
+  AlphaProfile* profiles[2] = { &deleglise_rivat_, &lmo_ };
+  const char* names[2] = { "deleglise_rivat", "lmo" };
+
+  for (int i = 0; i < 2; i++)
+  {
+    if (profiles[i]->coefficients.empty())
+      continue;
+
+    file << names[i] << " " << profiles[i]->min_x << " " << profiles[i]->max_x;
+    for (size_t j = 0; j < profiles[i]->coefficients.size(); j++)
+      file << " " << profiles[i]->coefficients[j];
+    file << endl;
+  }
+
+  cout << "Saved alpha profile to " << filename << endl;
+}
+
+/// Map log(x) of the profile's range to [-1, 1]
+double scale(const AlphaProfile& profile, double logx)
+{
+  double min_logx = log(profile.min_x);
+  double max_logx = log(profile.max_x);
+  double center = (min_logx + max_logx) / 2;
+  double radius = max((max_logx - min_logx) / 2, 1.0);
+
+  return (logx - center) / radius;
+}
+
+/// Least squares fit of y = c[0] t^n + ... + c[n],
+/// using the normal equations. The t values must be
+/// centered and scaled, see scale().
+///
+vector<double> fit(const vector<double>& t,
+                   const vector<double>& alpha,
+                   int degree)
+{
+  int n = degree + 1;
+  vector<vector<double> > m(n, vector<double>(n + 1, 0));
+
+  for (size_t k = 0; k < t.size(); k++)
+  {
+    vector<double> powers(n);
+    for (int i = 0; i < n; i++)
+      powers[i] = pow(t[k], degree - i);
+
+    for (int i = 0; i < n; i++)
+    {
+      for (int j = 0; j < n; j++)
+        m[i][j] += powers[i] * powers[j];
+      m[i][n] += powers[i] * alpha[k];
+    }
+  }
+
+  // Gaussian elimination with partial pivoting
+  for (int i = 0; i < n; i++)
+  {
+    int pivot = i;
+    for (int j = i + 1; j < n; j++)
+      if (fabs(m[j][i]) > fabs(m[pivot][i]))
+        pivot = j;
+
+    swap(m[i], m[pivot]);
+
+    if (m[i][i] == 0)
+      throw primecount_error("alpha fit failed, use a larger --tune limit");
+
+    for (int j = i + 1; j < n; j++)
+    {
+      double factor = m[j][i] / m[i][i];
+      for (int k = i; k <= n; k++)
+        m[j][k] -= factor * m[i][k];
+    }
+  }
+
+  vector<double> c(n);
+
+  for (int i = n - 1; i >= 0; i--)
+  {
+    double sum = m[i][n];
+    for (int j = i + 1; j < n; j++)
+      sum -= m[i][j] * c[j];
+    c[i] = sum / m[i][i];
+  }
+
+  return c;
+}
+
+/// Time the formulas of the Deleglise-Rivat
+/// algorithm which depend on alpha, S2_trivial(x, y)
+/// is omitted as it is fast for all alphas. The
+/// seconds of P2(x, y) and S2_hard(x, y) are
+/// extrapolated from a sample of their work.
+///
+double time_deleglise_rivat(int64_t x, double alpha, int threads)
+{
+  int64_t y = (int64_t) (iroot<3>(x) * alpha);
+  int64_t z = x / y;
+  int64_t c = PhiTiny::get_c(y);
+
+  double seconds = P2_sample_seconds(x, y, threads);
+  double time = get_wtime();
+  S1(x, y, c, threads);
+  S2_easy(x, y, z, c, threads);
+  seconds += get_wtime() - time;
+  seconds += S2_hard_sample_seconds(x, y, z, c, S2_hard_sample_percent, threads);
+
+  return seconds;
+}
+
+double time_lmo(int64_t x, double alpha, int threads)
+{
+  double old_alpha = get_alpha();
+  set_alpha(alpha);
+  double time = get_wtime();
+  pi_lmo_parallel3(x, threads);
+  set_alpha(old_alpha);
+
+  return get_wtime() - time;
+}
+
+/// Find the fastest alpha for x, first using a coarse
+/// grid around the default alpha, then refine it.
+/// Each alpha is timed twice, the faster run is used.
+///
+template <typename F>
+double fastest_alpha(int64_t x, double alpha, F time_alpha, int threads)
+{
+  double max_alpha = (double) iroot<6>(x);
+  double fastest = alpha;
+  double seconds = -1;
+
+  for (int refine = 0; refine < 2; refine++)
+  {
+    double center = fastest;
+    double step = (refine == 0) ? 0.5 : 0.125;
+
+    for (int i = -4; i <= 4; i++)
+    {
+      double a = in_between(1, center * pow(2.0, i * step), max_alpha);
+      double t = min(time_alpha(x, a, threads),
+                     time_alpha(x, a, threads));
+
+      if (seconds < 0 || t < seconds)
+      {
+        fastest = a;
+        seconds = t;
+      }
+    }
+  }
+
+  ios::fmtflags flags = cout.flags();
+  streamsize precision = cout.precision();
+
+  cout << "x = " << x
+       << ", alpha = " << fixed << setprecision(3) << fastest
+       << ", seconds = " << seconds << endl;
+
+  cout.flags(flags);
+  cout.precision(precision);
+
+  return fastest;
+}
+
+template <typename F>
+AlphaProfile tune_alpha(const char* name,
+                        int64_t min_x,
+                        int64_t max_x,
+                        double (*default_alpha)(maxint_t),
+                        F time_alpha,
+                        int degree,
+                        int threads)
+{
+  vector<double> logx;
+  vector<double> alpha;
+
+  cout << "=== Tuning " << name << " alpha ===" << endl;
+
+  // x = 10^10, 10^10.5, 10^11, ...
+  for (double e = log10((double) min_x); e <= log10((double) max_x) + 1e-9; e += 0.5)
+  {
+    int64_t x = (int64_t) pow(10.0, e);
+    logx.push_back(log((double) x));
+    alpha.push_back(fastest_alpha(x, default_alpha(x), time_alpha, threads));
+  }
+
+  AlphaProfile profile;
+  profile.min_x = (double) min_x;
+  profile.max_x = (double) max_x;
+
+  vector<double> t;
+  for (size_t i = 0; i < logx.size(); i++)
+    t.push_back(scale(profile, logx[i]));
+
+  profile.coefficients = fit(t, alpha, degree);
+
+  return profile;
+}
+
+/// @pre min_x <= x <= max_x
+double eval(const AlphaProfile& profile, double x)
+{
+  double t = scale(profile, log(x));
+  double alpha = 0;
+
+  for (size_t i = 0; i < profile.coefficients.size(); i++)
+    alpha = alpha * t + profile.coefficients[i];
+
+  return alpha;
+}
+
+/// Disables the alpha profile, the command-line alpha
+/// and the status output while tuning, the previous
+/// settings are restored when tune() returns or throws.
+///
+class TuneSettings
+{
+public:
+  TuneSettings()
+    : alpha_(get_alpha()),
+      print_status_(print_status())
+  {
+    ignore_profile_ = true;
+    set_alpha(-1);
+    set_print_status(false);
+  }
+
+  ~TuneSettings()
+  {
+    ignore_profile_ = false;
+    set_alpha(alpha_);
+    set_print_status(print_status_);
+  }
+private:
+  double alpha_;
+  bool print_status_;
+};
+
+} // namespace
+
+namespace primecount {
+
+/// Get the alpha of the profile generated by --tune. Outside
+/// of the tuned range the built-in formula is scaled by
+/// the profile's correction at the nearest tuned x.
+/// @param formula  Built-in alpha formula.
+/// @return false if there is no profile.
+///
+bool get_alpha_profile(const string& name,
+                       maxint_t x,
+                       double (*formula)(double),
+                       double* alpha)
+{
+  if (ignore_profile_)
+    return false;
+
+  #pragma omp critical (alpha_profile)
+  {
+    if (!is_loaded_)
+      load_profile();
+  }
+
+  AlphaProfile& profile = (name == "lmo") ? lmo_ : deleglise_rivat_;
+
+  if (profile.coefficients.empty())
+    return false;
+
+  double x2 = (double) x;
+  double nearest = in_between(profile.min_x, x2, profile.max_x);
+  *alpha = eval(profile, nearest);
+
+  if (nearest != x2)
+    *alpha *= formula(x2) / formula(nearest);
+
+  return true;
+}
+
+/// Tune the Deleglise-Rivat alpha for 10^10 <= x <= max_x
+/// and the LMO alpha for 10^8 <= x <= min(max_x, 10^11).
+/// The run time is dominated by the largest x.
+///
+void tune(int64_t max_x, int threads)
+{
+  // fitting a cubic requires at least 5 x values
+  if (max_x < ipow((int64_t) 10, 12))
+    throw primecount_error("--tune limit must be >= 1e12");
+
+  TuneSettings settings;
+  int64_t lmo_max_x = min(max_x, ipow((int64_t) 10, 11));
+
+  deleglise_rivat_ = tune_alpha("Deleglise-Rivat", ipow((int64_t) 10, 10), max_x,
+                                get_alpha_deleglise_rivat, time_deleglise_rivat, 3, threads);
+  lmo_ = tune_alpha("LMO", ipow((int64_t) 10, 8), lmo_max_x,
+                    get_alpha_lmo, time_lmo, 2, threads);
+
+  save_profile();
+}
+
+} // namespace